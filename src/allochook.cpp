@@ -0,0 +1,47 @@
+#include "allochook.h"
+
+#ifdef SAT_ALLOC_CHECK
+#include <cstdlib>
+#include <new>
+
+// 每個執行緒各自計數，證明檔的背景寫入執行緒不會影響求解器的檢查
+static thread_local long long allocCnt = 0;
+
+long long heapAllocCount()
+{
+    return allocCnt;
+}
+
+void *operator new(size_t n)
+{
+    ++allocCnt;
+    if (void *p = malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t n)
+{
+    return operator new(n);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+#endif
@@ -0,0 +1,10 @@
+#ifndef __ALLOCHOOK_H
+#define __ALLOCHOOK_H
+
+// 以 SAT_ALLOC_CHECK 建置時（cmake -DSAT_ALLOC_CHECK=ON），全域的 operator new
+// 會被替換成會計數的版本，求解器據此檢查穩定狀態下的衝突處理不會配置堆積記憶體。
+#ifdef SAT_ALLOC_CHECK
+long long heapAllocCount();     // 目前執行緒的堆積配置次數
+#endif
+
+#endif
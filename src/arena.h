@@ -0,0 +1,74 @@
+#ifndef __ARENA_H
+#define __ARENA_H
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "literal.h"
+#include "placement.h"
+using namespace std;
+
+
+// 子句文字的配置區
+// 以大區塊向系統要記憶體，子句只從目前的區塊切出一段；區塊配置後不會移動，
+// 因此子句可以直接保存指向文字的指標，學習新子句時也不需要個別配置。
+class LitArena
+{
+public:
+    inline Lit *alloc(int n);
+    inline size_t capacity() const { return total; }
+    inline size_t chunkSlots() const { return chunks.capacity(); }
+    template<class F> void forEachChunk(F f) const;
+
+    static constexpr size_t chunkSize = 1 << 20;  // 每個區塊的文字數
+    bool hugePages = false;     // 以透明大頁配置第一個之後的區塊
+
+protected:
+    struct ChunkFree
+    {
+        bool huge;
+        void operator()(Lit *p) const { if (huge) freeHuge(p); else delete[] p; }
+    };
+    struct Chunk
+    {
+        unique_ptr<Lit[], ChunkFree> lit;
+        size_t n;
+    };
+    vector<Chunk> chunks;
+    size_t used = 0;        // 目前區塊已使用的文字數
+    size_t chunkCap = 0;    // 目前區塊的容量
+    size_t total = 0;       // 所有區塊的總容量
+};
+
+
+/// @brief 配置 n 個連續的文字
+/// @param n 文字數量
+/// @return 指向配置空間的指標（在配置區存在期間都有效）
+inline Lit *LitArena::alloc(int n)
+{
+    if (used + (size_t)n > chunkCap)
+    {
+        chunkCap = max(chunkSize, (size_t)n);
+        // 只有第一個區塊用完（大型的配置區）才使用大頁，小問題不必付出清空大頁的成本
+        Lit *mem = (hugePages && total > 0) ? (Lit *)allocHuge(chunkCap * sizeof(Lit)) : nullptr;
+        if (mem == nullptr)
+            chunks.push_back({unique_ptr<Lit[], ChunkFree>(new Lit[chunkCap], ChunkFree{false}), chunkCap});
+        else
+            chunks.push_back({unique_ptr<Lit[], ChunkFree>(mem, ChunkFree{true}), chunkCap});
+        total += chunkCap;
+        used = 0;
+    }
+    Lit *p = chunks.back().lit.get() + used;
+    used += n;
+    return p;
+}
+
+/// @brief 對每個區塊呼叫 f(起始位址, 文字數)
+template<class F>
+void LitArena::forEachChunk(F f) const
+{
+    for (auto &c : chunks)
+        f((const Lit *)c.lit.get(), c.n);
+}
+
+#endif
@@ -0,0 +1,228 @@
+#include "cache.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <filesystem>
+namespace fs = std::filesystem;
+
+
+// splitmix64 的最後混合步驟
+static inline uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+
+// 已排序文字的雜湊；不同的 seed 得到兩個獨立的雜湊，tag 區分子句與基數約束
+static uint64_t hashLits(const vector<int> &lits, uint64_t seed, uint64_t tag)
+{
+    uint64_t h = mix64(seed ^ tag);
+    for (int l : lits)
+        h = mix64(h ^ (uint32_t)l);
+    return mix64(h ^ (uint64_t)lits.size());
+}
+
+
+string FormulaHash::hex() const
+{
+    char buf[33];
+    snprintf(buf, sizeof(buf), "%016llx%016llx", (unsigned long long)h[0], (unsigned long long)h[1]);
+    return buf;
+}
+
+
+/// @brief 計算公式的正規化雜湊：每個子句排序並去除重複文字後各自雜湊，
+///        再以加總合併，與子句的順序無關。
+/// @param clauses 子句
+/// @param cards 基數約束
+/// @param maxVarIndex 最大變數索引
+/// @return 128 位元的雜湊
+FormulaHash hashFormula(const vector<vector<int>> &clauses, const vector<CardConstraint> &cards,
+                        int maxVarIndex)
+{
+    const uint64_t seed0 = 0x9E3779B97F4A7C15ULL, seed1 = 0xD1B54A32D192ED03ULL;
+    FormulaHash key;
+    vector<int> tmp;
+    for (auto &cls : clauses)
+    {
+        tmp.assign(cls.begin(), cls.end());
+        sort(tmp.begin(), tmp.end());
+        tmp.erase(unique(tmp.begin(), tmp.end()), tmp.end());
+        key.h[0] += hashLits(tmp, seed0, 0);
+        key.h[1] += hashLits(tmp, seed1, 0);
+    }
+    // 基數約束中重複的文字會被計算兩次，不能去除
+    for (auto &cd : cards)
+    {
+        tmp.assign(cd.lit.begin(), cd.lit.end());
+        sort(tmp.begin(), tmp.end());
+        key.h[0] += hashLits(tmp, seed0, 1 + (uint64_t)cd.k);
+        key.h[1] += hashLits(tmp, seed1, 1 + (uint64_t)cd.k);
+    }
+    key.h[0] = mix64(key.h[0] ^ (uint64_t)maxVarIndex);
+    key.h[1] = mix64(key.h[1] + (uint64_t)maxVarIndex * seed0);
+    return key;
+}
+
+
+/// @brief 檢查快取的模型是否滿足公式（雜湊碰撞或檔案損壞時不得使用）
+bool CacheEntry::satisfies(const vector<vector<int>> &clauses, const vector<CardConstraint> &cards) const
+{
+    auto isTrue = [this](int lit) {
+        size_t v = (size_t)abs(lit);
+        return v < model.size() && model[v] == lit;
+    };
+    for (auto &cls : clauses)
+    {
+        bool satisfied = false;
+        for (int lit : cls)
+            satisfied |= isTrue(lit);
+        if (!satisfied)
+            return false;
+    }
+    for (auto &cd : cards)
+    {
+        int cnt = 0;
+        for (int lit : cd.lit)
+            cnt += isTrue(lit);
+        if (cnt > cd.k)
+            return false;
+    }
+    return true;
+}
+
+
+/// @brief 開啟快取目錄，不存在時建立
+/// @param path 目錄
+/// @return 是否可以使用
+bool ResultCache::open(const char *path)
+{
+    error_code ec;
+    fs::create_directories(path, ec);
+    dir = path;
+    return fs::is_directory(dir, ec);
+}
+
+
+string ResultCache::pathOf(const FormulaHash &key) const
+{
+    return dir + "/" + key.hex() + ".res";
+}
+
+
+/// @brief 讀取快取的結果
+/// @param key 公式雜湊
+/// @param entry 讀到的結果
+/// @return 是否有完整且雜湊相符的項目
+bool ResultCache::lookup(const FormulaHash &key, CacheEntry &entry) const
+{
+    FILE *in = fopen(pathOf(key).c_str(), "r");
+    if (in == NULL)
+        return false;
+
+    entry = CacheEntry();
+    bool keyOk = false, statusOk = false, modelOk = false;
+    char kind, word[32];
+    unsigned long long h0, h1;
+    while (fscanf(in, " %c", &kind) == 1)
+    {
+        if (kind == 'h') {
+            keyOk = fscanf(in, "%16llx%16llx", &h0, &h1) == 2 && h0 == key.h[0] && h1 == key.h[1];
+        }
+        else if (kind == 's' && fscanf(in, "%31s", word) == 1) {
+            statusOk = true;
+            if (strcmp(word, "SATISFIABLE") == 0)
+                entry.status = 1;
+            else if (strcmp(word, "UNSATISFIABLE") == 0)
+                entry.status = 0;
+            else if (strcmp(word, "UNKNOWN") == 0)
+                entry.status = -1;
+            else
+                statusOk = false;
+        }
+        else if (kind == 'v') {
+            entry.model.assign(1, 1);
+            int lit;
+            while (fscanf(in, "%d", &lit) == 1 && lit != 0)
+                entry.model.push_back(lit);
+            modelOk = lit == 0;
+        }
+        else if (kind == 't') {
+            if (fscanf(in, "%d", &entry.tried) != 1)
+                break;
+        }
+        else if (kind == 'b') {
+            if (fscanf(in, "%d", &entry.bestUnsat) != 1)
+                break;
+        }
+        else if (fscanf(in, "%*[^\n]") < 0)
+            break;
+    }
+    fclose(in);
+    return keyOk && statusOk && (entry.status != 1 || modelOk);
+}
+
+
+/// @brief 寫入結果：先寫到唯一的暫存檔再改名取代，讀取的行程不會看到寫到一半的檔案。
+///        未知的結果不覆蓋已知的結果，並與既有的界限合併。
+/// @param key 公式雜湊
+/// @param entry 結果
+/// @return 是否寫入成功
+bool ResultCache::store(const FormulaHash &key, const CacheEntry &entry) const
+{
+    CacheEntry merged = entry;
+    CacheEntry old;
+    if (entry.status < 0 && lookup(key, old))
+    {
+        if (old.status >= 0)
+            return true;
+        merged.tried = max(merged.tried, old.tried);
+        if (old.bestUnsat >= 0 && (merged.bestUnsat < 0 || old.bestUnsat < merged.bestUnsat))
+            merged.bestUnsat = old.bestUnsat;
+    }
+
+    string path = pathOf(key);
+    random_device rd;
+    uint64_t salt = ((uint64_t)rd() << 32) ^ rd() ^
+        (uint64_t)chrono::steady_clock::now().time_since_epoch().count();
+    string tmp = path + ".tmp" + to_string(salt);
+    FILE *out = fopen(tmp.c_str(), "w");
+    if (out == NULL)
+        return false;
+
+    fprintf(out, "c sat-solver result cache\nh %s\n", key.hex().c_str());
+    if (merged.status == 1)
+    {
+        fputs("s SATISFIABLE\nv", out);
+        for (size_t i = 1; i < merged.model.size(); ++i)
+            fprintf(out, " %d", merged.model[i]);
+        fputs(" 0\n", out);
+    }
+    else if (merged.status == 0)
+        fputs("s UNSATISFIABLE\n", out);
+    else
+    {
+        fprintf(out, "s UNKNOWN\nt %d\n", merged.tried);
+        if (merged.bestUnsat >= 0)
+            fprintf(out, "b %d\n", merged.bestUnsat);
+    }
+    bool ok = fflush(out) == 0;
+    ok &= fclose(out) == 0;
+
+    error_code ec;
+    if (ok)
+        fs::rename(tmp, path, ec);
+    if (!ok || ec) {
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
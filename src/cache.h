@@ -0,0 +1,48 @@
+#ifndef __CACHE_H
+#define __CACHE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "parser.h"
+using namespace std;
+
+
+// 公式的正規化雜湊：與子句順序及子句內文字順序無關（重複的文字只計一次）
+struct FormulaHash
+{
+    uint64_t h[2] = {0, 0};
+    string hex() const;
+};
+
+FormulaHash hashFormula(const vector<vector<int>> &clauses, const vector<CardConstraint> &cards,
+                        int maxVarIndex);
+
+
+// 快取的求解結果
+struct CacheEntry
+{
+    int status = -1;            // 1：SAT，0：UNSAT，-1：未知（超時）
+    vector<int> model;          // SAT 時的模型，格式同 solver::result()
+    int tried = 0;              // 未知時已嘗試過的最長超時時間（秒）
+    int bestUnsat = -1;         // 未知時已知的最少不滿足子句數（-1 表示沒有）
+
+    bool satisfies(const vector<vector<int>> &clauses, const vector<CardConstraint> &cards) const;
+};
+
+
+// 以公式雜湊為鍵、存放在目錄中的結果快取，每個公式一個檔案。
+// 寫入時先寫暫存檔再改名取代，多個行程同時讀寫時只會看到完整的檔案。
+class ResultCache
+{
+public:
+    bool open(const char *dir);
+    bool lookup(const FormulaHash &key, CacheEntry &entry) const;
+    bool store(const FormulaHash &key, const CacheEntry &entry) const;
+
+protected:
+    string dir;
+    string pathOf(const FormulaHash &key) const;
+};
+
+#endif
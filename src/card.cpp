@@ -0,0 +1,248 @@
+#include "solver.h"
+
+/******************************************************
+    Cardinality constraints (at-most-k)
+******************************************************/
+
+/// @brief 新增 at-most-k 約束：lits 中至多 k 個文字為真。需在第 0 層呼叫，
+///        變數必須在 CNF 檔的變數範圍內；已為真的文字會立即計數並傳播。
+/// @param lits DIMACS 文字
+/// @param k 上限
+/// @return 若約束使問題不可滿足則回傳 false；否則回傳 true。
+bool solver::addAtMost(const vector<int> &lits, int k)
+{
+    int n = (int)lits.size();
+    if (k < 0) {
+        unsatAfterInit = 1;
+        return false;
+    }
+    // 文字數量不超過上限：恆成立
+    if (n <= k)
+        return true;
+
+    if (cardOcc.empty())
+        cardOcc.assign((maxVarIndex+4) << 1, vector<int>());
+
+    int c = (int)cards.size();
+    CardInfo cd;
+    cd.lit = (int)cardLits.size();
+    cd.n = n;
+    cd.k = k;
+    cd.cnt = 0;
+    cd.tru = (int)cardTrue.size();
+    for (int l : lits)
+    {
+        cardLits.push_back(toLit(l));
+        cardOcc[toLit(l)].push_back(c);
+    }
+    cardTrue.resize(cardTrue.size() + k + 1);
+    cards.push_back(cd);
+    // 解釋子句最多 k+1 個文字，預先配置以免衝突處理時配置記憶體
+    if ((int)cardExpl.capacity() < k + 2)
+        cardExpl.reserve(k + 2);
+
+    // 計入第 0 層已為真的文字
+    CardInfo &now = cards[c];
+    for (int i = 0; i < n; ++i)
+    {
+        Lit l = cardLits[now.lit + i];
+        if (var.litVal(l) == 1) {
+            if (now.cnt <= k)
+                cardTrue[now.tru + now.cnt] = l;
+            ++now.cnt;
+        }
+    }
+    if (now.cnt > k) {
+        unsatAfterInit = 1;
+        return false;
+    }
+    if (now.cnt == k)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            Lit l = cardLits[cards[c].lit + i];
+            if (var.litVal(l) == 2 && !set(litNeg(l))) {
+                unsatAfterInit = 1;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+/// @brief 文字 lit 剛被設為真：更新含有它的約束的計數，
+///        超過上限即為衝突，剛好達到上限時其餘未賦值的文字皆為假。
+/// @param lit 剛被設為真的文字
+/// @return 若沒有衝突則回傳 true；否則回傳 false
+bool solver::propagateCards(Lit lit)
+{
+    const vector<int> &occ = cardOcc[lit];
+    if (occ.empty())
+        return true;
+
+    // 先更新所有計數，回溯時才能一一對應地撤銷
+    for (int c : occ)
+    {
+        CardInfo &cd = cards[c];
+        if (cd.cnt <= cd.k)
+            cardTrue[cd.tru + cd.cnt] = lit;
+        ++cd.cnt;
+    }
+
+    for (int c : occ)
+    {
+        const CardInfo &cd = cards[c];
+        if (cd.cnt > cd.k)
+        {
+            cardConflict = c;
+            conflictingClsID = CARD_CONFLICT;
+            ++cardConflicts;
+            return false;
+        }
+        if (cd.cnt < cd.k)
+            continue;
+        for (int i = 0; i < cd.n; ++i)
+        {
+            Lit l = cardLits[cd.lit + i];
+            if (var.litVal(l) != 2)
+                continue;
+            ++cardProps;
+            if (!set(litNeg(l), CARD_REASON - c))
+                return false;
+        }
+    }
+    return true;
+}
+
+
+/// @brief 產生基數約束的解釋子句並放在 cardExpl。
+///        約束達到上限時才會推導，因此前 k 個記錄的真文字就是推導的原因；
+///        衝突時則是前 k+1 個。
+/// @param c 約束
+/// @param vid 由約束推導的變數；0 表示產生衝突子句
+void solver::cardExplain(int c, int vid)
+{
+    const CardInfo &cd = cards[c];
+    int m = vid ? cd.k : cd.k + 1;
+    cardExpl.clear();
+    if (vid)
+        cardExpl.push_back(mkLit(vid, var.getVal(vid)));
+    for (int i = 0; i < m; ++i)
+        cardExpl.push_back(litNeg(cardTrue[cd.tru + i]));
+}
+
+
+/// @brief 以等價的子句為基數約束計分：at-most-k 相當於任取 k+1 個文字的反文字組成的子句，
+///        每個反文字出現在 C(n-1, k) 個大小為 k+1 的子句中。
+/// @param mom 使用 MOM（只計算小子句的出現次數）或 JW 分數
+void solver::scoreCards(bool mom)
+{
+    for (const CardInfo &cd : cards)
+    {
+        int sz = cd.k + 1;
+        if (mom && sz > params.clauseSzThreshold)
+            continue;
+        double logCnt = lgamma((double)cd.n) - lgamma((double)cd.k + 1) - lgamma((double)(cd.n - cd.k));
+        double w = mom ? exp(logCnt) : exp(logCnt - sz * log(2.0));
+        for (int i = 0; i < cd.n; ++i)
+        {
+            Lit l = cardLits[cd.lit + i];
+            varPriQueue.increaseInitPri(litVar(l), w, !litSign(l));
+        }
+    }
+}
+
+
+/// @brief 從成對編碼的二元子句中偵測 at-most-one 約束，並刪除被取代的二元子句。
+///        二元子句 (a ∨ b) 表示 ¬a 與 ¬b 至多一個為真，以貪婪法在這些文字之間找團。
+/// @param raw 原始子句
+/// @param found 偵測到的約束
+void solver::detectAtMostOne(vector<vector<int>> &raw, vector<CardConstraint> &found)
+{
+    TRACE_SCOPE("detectAtMostOne");
+    vector<vector<Lit>> adj((maxVarIndex+1) << 1);
+    for (auto &cls : raw)
+    {
+        if (cls.size() != 2 || abs(cls[0]) == abs(cls[1]))
+            continue;
+        Lit a = litNeg(toLit(cls[0])), b = litNeg(toLit(cls[1]));
+        adj[a].push_back(b);
+        adj[b].push_back(a);
+    }
+    vector<Lit> order;
+    for (Lit l = 0; l < (Lit)adj.size(); ++l)
+    {
+        if ((int)adj[l].size() + 1 < cardDetectMin)
+            continue;
+        sort(adj[l].begin(), adj[l].end());
+        adj[l].erase(unique(adj[l].begin(), adj[l].end()), adj[l].end());
+        order.push_back(l);
+    }
+    if (order.empty())
+        return;
+    // 度數大的文字優先，較可能屬於大的團
+    sort(order.begin(), order.end(), [&adj](Lit a, Lit b) {
+        return adj[a].size() > adj[b].size() || (adj[a].size() == adj[b].size() && a < b);
+    });
+
+    auto key = [](Lit a, Lit b) {
+        return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+    };
+    auto hasEdge = [&adj](Lit a, Lit b) {
+        return binary_search(adj[a].begin(), adj[a].end(), b);
+    };
+    unordered_set<uint64_t> used;
+    long long steps = 0;
+    vector<Lit> clique;
+    for (Lit a : order)
+    {
+        if (steps >= cardDetectSteps)
+            break;
+        clique.assign(1, a);
+        for (Lit b : adj[a])
+        {
+            if (used.count(key(a, b)))
+                continue;
+            bool ok = true;
+            for (size_t i = 1; i < clique.size() && ok; ++i)
+            {
+                ++steps;
+                ok = hasEdge(b, clique[i]) && !used.count(key(b, clique[i]));
+            }
+            if (ok)
+                clique.push_back(b);
+        }
+        if ((int)clique.size() < cardDetectMin)
+            continue;
+
+        CardConstraint cd;
+        cd.k = 1;
+        for (size_t i = 0; i < clique.size(); ++i)
+        {
+            cd.lit.push_back(toDimacs(clique[i]));
+            for (size_t j = i + 1; j < clique.size(); ++j)
+                used.insert(key(clique[i], clique[j]));
+        }
+        found.push_back(move(cd));
+        ++cardsDetected;
+    }
+    if (used.empty())
+        return;
+
+    // 刪除被約束取代的二元子句
+    size_t j = 0;
+    for (size_t i = 0; i < raw.size(); ++i)
+    {
+        auto &cls = raw[i];
+        if (cls.size() == 2 && abs(cls[0]) != abs(cls[1]) &&
+            used.count(key(litNeg(toLit(cls[0])), litNeg(toLit(cls[1]))))) {
+            ++cardRemovedCls;
+            continue;
+        }
+        if (j != i)
+            raw[j] = move(raw[i]);
+        ++j;
+    }
+    raw.resize(j);
+}
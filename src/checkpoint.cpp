@@ -0,0 +1,187 @@
+#include "solver.h"
+
+/******************************************************
+    Checkpoint and Resume
+******************************************************/
+
+/// @brief 回溯到第 0 層並取得求解狀態。學習子句中第 0 層為假的文字會被移除，
+///        已被滿足的學習子句不記錄。
+/// @param s 輸出的快照
+void solver::takeSnapshot(SolverSnapshot &s)
+{
+    TRACE_SCOPE("snapshot");
+    if (nowLevel > 0) {
+        backtrack(0);
+        nowLevel = 0;
+    }
+
+    s.formula = formulaHash;
+    s.mode = runMode;
+    s.seed = seed;
+    s.maxVar = maxVarIndex;
+    s.elapsed = elapsedBefore + runTime;
+
+    s.rng = rng;
+    s.conflicts = conflicts;
+    s.decisions = decisions;
+    s.propagations = propagations;
+    s.restarts = restarts;
+    s.vivifiedLits = vivifiedLits;
+    s.minimizedLits = minimizedLits;
+    s.rephases = rephases;
+    s.simplifies = simplifies;
+    s.simpRemovedCls = simpRemovedCls;
+    s.simpRemovedLits = simpRemovedLits;
+    s.gaussProps = gaussProps;
+    s.gaussConflicts = gaussConflicts;
+    s.cardProps = cardProps;
+    s.cardConflicts = cardConflicts;
+    s.lsBestUnsat = lsBestUnsat;
+    s.nextRestart = nextRestart;
+    s.nextVivify = nextVivify;
+    s.lastVivifyProps = lastVivifyProps;
+    s.nextSimplify = nextSimplify;
+    s.nextRephase = nextRephase;
+
+    s.trail.assign(var.trail.begin(), var.trail.begin() + (var._top + 1));
+    s.learntLits.clear();
+    s.learntLbd.clear();
+    s.learntVivified.clear();
+    for (int cid = oriClsNum; cid < (int)clauses.size(); ++cid)
+    {
+        const Clause &cls = clauses[cid];
+        size_t start = s.learntLits.size();
+        bool satisfied = false;
+        for (Lit lit : cls)
+        {
+            int val = var.litVal(lit);
+            if (val == 1) {
+                satisfied = true;
+                break;
+            }
+            if (val == 2)
+                s.learntLits.push_back(lit);
+        }
+        if (satisfied) {
+            s.learntLits.resize(start);
+            continue;
+        }
+        s.learntLits.push_back(0);
+        s.learntLbd.push_back(cls.lbd);
+        s.learntVivified.push_back(cls.vivified);
+    }
+    s.phase = phaseRecord;
+    varPriQueue.save(s.heap);
+}
+
+
+/// @brief 將求解狀態寫入快照檔
+/// @param filename 快照檔名
+/// @return 是否成功
+bool solver::saveSnapshot(const char *filename)
+{
+    SolverSnapshot s;
+    takeSnapshot(s);
+    if (!s.save(filename)) {
+        fprintf(stderr, "WARNING! Could not write checkpoint: %s\n", filename);
+        return false;
+    }
+    ++checkpoints;
+    return true;
+}
+
+
+/// @brief 搜尋迴圈中的快照點：定期寫入快照，收到停止訊號時寫入後結束搜尋
+void solver::checkpoint()
+{
+    saveSnapshot(checkpointFile);
+    if (stopRequested)
+        interrupted = true;
+    else
+        nextCheckpoint = runTime + max(checkpointInterval, 1);
+}
+
+
+/// @brief 在預處理與啟發式初始化之後還原快照中的搜尋狀態，需在第 0 層呼叫。
+///        第 0 層賦值與學習子句都被目前的子句資料庫所蘊含，依序加入並傳播。
+/// @param s 由相同輸入、執行模式與亂數種子產生的快照
+/// @return 若發現問題不可滿足則回傳 false；否則回傳 true
+bool solver::restoreSnapshot(const SolverSnapshot &s)
+{
+    TRACE_SCOPE("resume");
+    elapsedBefore = s.elapsed;
+    rng = s.rng;
+    conflicts = s.conflicts;
+    decisions = s.decisions;
+    propagations = s.propagations;
+    restarts = s.restarts;
+    vivifiedLits = s.vivifiedLits;
+    minimizedLits = s.minimizedLits;
+    rephases = s.rephases;
+    simplifies = s.simplifies;
+    simpRemovedCls = s.simpRemovedCls;
+    simpRemovedLits = s.simpRemovedLits;
+    gaussProps = s.gaussProps;
+    gaussConflicts = s.gaussConflicts;
+    cardProps = s.cardProps;
+    cardConflicts = s.cardConflicts;
+    lsBestUnsat = s.lsBestUnsat;
+    nextRestart = s.nextRestart;
+    nextVivify = s.nextVivify;
+    lastVivifyProps = s.lastVivifyProps;
+    nextSimplify = s.nextSimplify;
+    nextRephase = s.nextRephase;
+    phaseRecord = s.phase;
+    // 堆積不符時保留初始化的堆積，只影響決策順序
+    varPriQueue.load(s.heap);
+
+    nowLevel = 0;
+    for (Lit lit : s.trail)
+    {
+        int val = var.litVal(lit);
+        if (val == 0 || (val == 2 && !set(lit)))
+            return false;
+    }
+
+    // 學習子句：略過已被滿足的，移除為假的文字（傳播可能產生新的第 0 層賦值）
+    vector<Lit> &cls = nowLearnt;
+    size_t k = 0;
+    for (size_t i = 0; i < s.learntLbd.size(); ++i)
+    {
+        cls.clear();
+        bool satisfied = false;
+        for (; s.learntLits[k] != 0; ++k)
+        {
+            int val = var.litVal(s.learntLits[k]);
+            satisfied |= val == 1;
+            if (val == 2)
+                cls.push_back(s.learntLits[k]);
+        }
+        ++k;
+        if (satisfied)
+            continue;
+        if (cls.empty())
+            return false;
+        if (cls.size() == 1)
+        {
+            Lit lit = cls[0];
+            if (!set(lit))
+                return false;
+            unit.emplace_back(lit);
+            continue;
+        }
+        int cid = newClause(cls.data(), (int)cls.size());
+        clauses[cid].watcher[0] = 0;
+        clauses[cid].watcher[1] = 1;
+        clauses[cid].lbd = s.learntLbd[i];
+        clauses[cid].vivified = s.learntVivified[i] != 0;
+        watchers.resize(watchers.size()+2);
+        initWatcherList(cid);
+    }
+
+    // 所有未賦值的變數都必須在堆積中，否則不會被選為決策
+    for (int v = 1; v <= maxVarIndex; ++v)
+        if (var.getVal(v) == 2)
+            varPriQueue.restore(v);
+    return true;
+}
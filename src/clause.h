@@ -3,30 +3,41 @@
 
 #include <cstdlib>
 #include <vector>
+#include "literal.h"
 using namespace std;
 
 
 struct Clause
 {
-    // Literal in clause. ex: -1 2 3 -4 5
+    // Literal in clause, encoded as 2*var+sign (see literal.h)
+    // lit points into the solver's LitArena; shrinking a clause keeps its storage
     // watcher -> index of watched variable in lit
-    vector<int> lit;
+    Lit *lit = nullptr;
+    int sz = 0;
     int watcher[2];
     int simpleCnt[2];
+    int lbd = 0;            // literal block distance (學習子句)
+    bool vivified = false;  // 是否已經做過 vivification
 
     inline int size() const {
-        return (int)lit.size();
+        return sz;
     }
-    inline int getLit(int id) const {
+    inline Lit *begin() const {
+        return lit;
+    }
+    inline Lit *end() const {
+        return lit + sz;
+    }
+    inline Lit getLit(int id) const {
         return lit[id];
     }
     inline int getVar(int id) const {
-        return abs(lit[id]);
+        return litVar(lit[id]);
     }
     inline int getSign(int id) const {
-        return lit[id] > 0;
+        return litSign(lit[id]);
     }
-    inline int getWatchLit(int wid) const {
+    inline Lit getWatchLit(int wid) const {
         return getLit(watcher[wid]);
     }
     inline int getWatchVar(int wid) const {
@@ -40,7 +51,11 @@ struct Clause
     }
     inline void watchNext(int wid) {
         unsigned int v = watcher[wid] + 1;
-        watcher[wid] = v & (int(v == lit.size()) - 1);
+        watcher[wid] = v & (int(v == (unsigned int)sz) - 1);
+    }
+    inline void removeLit(int id) {
+        // Move the last literal into slot id
+        lit[id] = lit[--sz];
     }
 
 };
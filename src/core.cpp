@@ -0,0 +1,217 @@
+#include "solver.h"
+
+/******************************************************
+    Assumptions and UNSAT cores
+******************************************************/
+
+/// @brief 在假設下求解：假設文字依序作為最前面的決策，學習子句與啟發式資訊
+///        在多次呼叫之間保留。需在 init 之後呼叫，取代 solve。
+/// @param assumptions 假設的 DIMACS 文字，變數必須在 CNF 檔的變數範圍內
+/// @return 是否可滿足；不可滿足且未超時時，failed() 為導致不可滿足的假設子集
+bool solver::solveAssuming(const vector<int> &assumptions)
+{
+    time(&startTime);
+    assumps.clear();
+    for (int l : assumptions)
+        assumps.push_back(toLit(l));
+    sat = searchAssuming();
+    failedDimacs.clear();
+    for (Lit l : failedAssumps)
+        failedDimacs.push_back(toDimacs(l));
+    return sat;
+}
+
+
+/// @brief 導致不可滿足的假設（最近一次 solveAssuming 的結果）
+const vector<int> &solver::failed() const
+{
+    return failedDimacs;
+}
+
+
+/// @brief UNSAT core 中原始子句的索引（最近一次 solveCore 的結果）
+const vector<int> &solver::core() const
+{
+    return coreIdx;
+}
+
+
+/// @brief 以 assumps 中的假設搜尋，第一次呼叫時先預處理並初始化啟發式資訊。
+/// @return 是否可滿足
+bool solver::searchAssuming()
+{
+    failedAssumps.clear();
+    if (!searchReady)
+    {
+        // 刪除被阻擋的子句在假設下不保持可滿足性，不使用
+        runMode &= ~(BCE | CCE);
+        searchReady = true;
+        if( unsatAfterInit || !preprocess() || !initGauss() ) {
+            unsatAfterInit = 1;
+            return false;
+        }
+        initHeuristic();
+        assumpAt.assign(maxVarIndex + 2, 0);
+    }
+    if (unsatAfterInit)
+        return false;
+
+    backtrack(0);
+    nowLevel = 0;
+    bool res = _solve();
+    // 不依賴假設的不可滿足：之後的呼叫都直接回傳
+    if (!res && failedAssumps.empty() && runTime <= timeout)
+        unsatAfterInit = 1;
+    return res;
+}
+
+
+/// @brief 在新的決策層級 nowLevel 取得下一個要決策的假設，已為真的假設直接略過。
+///        assumpAt[lv] 記錄第 lv 層之後要從哪個假設繼續，回溯後不需重新掃描。
+/// @param lit 要決策的假設文字
+/// @return 1：有假設要決策；0：所有假設皆已為真；-1：有假設為假（結果放在 failedAssumps）
+int solver::nextAssumption(Lit &lit)
+{
+    int n = (int)assumps.size();
+    int i = assumpAt[nowLevel - 1];
+    while (i < n && var.litVal(assumps[i]) == 1)
+        ++i;
+    assumpAt[nowLevel] = i < n ? i + 1 : n;
+    if (i == n)
+        return 0;
+    if (var.litVal(assumps[i]) == 0) {
+        analyzeFinal(assumps[i]);
+        return -1;
+    }
+    lit = assumps[i];
+    return 1;
+}
+
+
+/// @brief 假設 p 為假：沿著軌跡往回找出蘊含 ¬p 的假設（第 0 層以上的決策都是假設），
+///        與 p 一起放在 failedAssumps。
+/// @param p 為假的假設
+void solver::analyzeFinal(Lit p)
+{
+    failedAssumps.clear();
+    failedAssumps.push_back(p);
+    if (var.getLv(litVar(p)) == 0)
+        return;
+
+    litMarker.clear();
+    litMarker.set(litVar(p), 1);
+    for (int i = var._top; i >= 0; --i)
+    {
+        Lit lit = var.at(i);
+        int x = litVar(lit);
+        if (var.getLv(x) == 0)
+            break;
+        if (litMarker.get(x) == -1)
+            continue;
+        if (var.getSrc(x) == -1) {
+            failedAssumps.push_back(lit);
+            continue;
+        }
+        const Lit *reason;
+        int n;
+        reasonOf(x, reason, n);
+        for (int k = 0; k < n; ++k)
+        {
+            int v = litVar(reason[k]);
+            if (v != x && var.getLv(v) > 0)
+                litMarker.set(v, 1);
+        }
+    }
+}
+
+
+/// @brief 在第 0 層固定選擇變數，之後的求解不再需要假設它。
+/// @param lit 要設為真的選擇文字
+/// @return 若固定後不可滿足則回傳 false；否則回傳 true
+bool solver::fixSelector(Lit lit)
+{
+    backtrack(0);
+    nowLevel = 0;
+    if (var.litVal(lit) == 1)
+        return true;
+    if (!set(lit))
+        return false;
+    unit.emplace_back(lit);
+    return true;
+}
+
+
+/// @brief 求解並在不可滿足時找出 UNSAT core：假設所有選擇變數為真，失敗的假設就是 core。
+///        最小化時依序嘗試刪除 core 中的子句並重用同一個求解器：
+///        仍不可滿足則以新的失敗假設取代 core，並在第 0 層停用其餘子句；
+///        變成可滿足則子句是必要的，在第 0 層固定啟用。需以 trackCore 初始化。
+/// @param minimize 是否最小化 core（超時則回傳目前的 core）
+/// @return 是否可滿足；不可滿足時 core() 為原始子句的索引
+bool solver::solveCore(bool minimize)
+{
+    TRACE_SCOPE("solveCore");
+    time(&startTime);
+    coreIdx.clear();
+    coreMinimal = false;
+    coreCalls = 1;
+    assumps.clear();
+    for (int i = 0; i < coreCls; ++i)
+        assumps.push_back(mkLit(coreVars + 1 + i, 1));
+    sat = searchAssuming();
+    if (sat || runTime > timeout)
+        return sat;
+
+    vector<Lit> core(failedAssumps), kept;
+    int unsatTime = runTime;
+    if (minimize)
+    {
+        coreMinimal = true;
+        vector<char> inFailed(coreCls, 0);
+        while (!core.empty())
+        {
+            Lit c = core.back();
+            core.pop_back();
+            assumps = core;
+            ++coreCalls;
+            if (searchAssuming())
+            {
+                // 刪除後可滿足：子句是必要的，之後的求解都包含它
+                kept.push_back(c);
+                if (!fixSelector(c))
+                    core.clear();
+                continue;
+            }
+            if (runTime > timeout) {
+                core.push_back(c);
+                coreMinimal = false;
+                break;
+            }
+
+            // 不在新的失敗假設中的子句都不需要
+            for (Lit l : failedAssumps)
+                inFailed[litVar(l) - coreVars - 1] = 1;
+            fixSelector(litNeg(c));
+            size_t j = 0;
+            for (Lit l : core)
+            {
+                if (inFailed[litVar(l) - coreVars - 1])
+                    core[j++] = l;
+                else
+                    fixSelector(litNeg(l));
+            }
+            core.resize(j);
+            for (Lit l : failedAssumps)
+                inFailed[litVar(l) - coreVars - 1] = 0;
+        }
+        // 最小化超時不影響不可滿足的結論
+        runTime = unsatTime;
+    }
+
+    for (Lit l : core)
+        coreIdx.push_back(litVar(l) - coreVars - 1);
+    for (Lit l : kept)
+        coreIdx.push_back(litVar(l) - coreVars - 1);
+    sort(coreIdx.begin(), coreIdx.end());
+    sat = 0;
+    return false;
+}
@@ -0,0 +1,242 @@
+#include "solver.h"
+
+/******************************************************
+    Blocked Clause Elimination (BCE)
+    Covered Clause Elimination (CCE)
+******************************************************/
+
+/// @brief 在出現列表上執行 BCE（以及可選的 CCE），並將刪除的子句記錄到模型重建堆疊。
+void solver::eliminateBlocked()
+{
+    TRACE_SCOPE("eliminateBlocked");
+    int n = (int)clauses.size();
+
+    // 建立出現列表
+    occurs.assign((maxVarIndex+1) << 1, vector<int>());
+    eliminated.assign(n, 0);
+    coverCnt.init((maxVarIndex+1) << 1);
+    for (int cid=0; cid<n; ++cid)
+    {
+        for (int i=0; i<clauses[cid].size(); ++i)
+            occurs[clauses[cid].getLit(i)].push_back(cid);
+    }
+
+    // 所有子句都先放入待檢查佇列
+    vector<int> queue(n);
+    vector<char> queued(n, 1);
+    for (int cid=0; cid<n; ++cid)
+        queue[cid] = cid;
+
+    vector<Lit> cover;
+    vector<ReconEntry> steps;
+    size_t head = 0;
+    while (head < queue.size() && elimSteps < elimStepLimit)
+    {
+        int cid = queue[head++];
+        queued[cid] = 0;
+        if (eliminated[cid])
+            continue;
+
+        Lit blk = findBlockingLit(cid);
+        if (blk != 0)
+        {
+            reconStack.push_back({blk, vector<Lit>(clauses[cid].begin(), clauses[cid].end())});
+        }
+        else if ((runMode & CCE))
+        {
+            steps.clear();
+            blk = coverClause(cid, cover, steps);
+            if (blk == 0)
+                continue;
+            // 先記錄每一步的覆蓋文字擴充，最後才是被阻擋的擴充子句
+            for (auto &e : steps)
+                reconStack.push_back(move(e));
+            reconStack.push_back({blk, cover});
+        }
+        else
+        {
+            continue;
+        }
+
+        // 刪除子句後，含有其反文字的子句可能因此被阻擋
+        eliminated[cid] = 1;
+        if (proof)
+            proof->del(clauses[cid].lit, clauses[cid].size());
+        for (int i=0; i<clauses[cid].size(); ++i)
+        {
+            for (int d : occurs[litNeg(clauses[cid].getLit(i))])
+            {
+                if (!eliminated[d] && !queued[d])
+                {
+                    queued[d] = 1;
+                    queue.push_back(d);
+                }
+            }
+        }
+    }
+
+    // 壓縮子句資料庫
+    int j = 0;
+    for (int cid=0; cid<n; ++cid)
+    {
+        if (!eliminated[cid])
+        {
+            if (j != cid)
+                clauses[j] = move(clauses[cid]);
+            ++j;
+        }
+    }
+    clauses.resize(j);
+    oriClsNum = (int)clauses.size();
+
+    vector<vector<int>>().swap(occurs);
+    vector<char>().swap(eliminated);
+    initAllWatcherList();
+}
+
+
+/// @brief 檢查子句是否為被阻擋子句 (blocked clause)。
+/// @param cid 子句的 ID
+/// @return 阻擋文字；若子句未被阻擋則回傳 0（變數 0 不存在，不會是合法文字）
+Lit solver::findBlockingLit(int cid)
+{
+    const Clause &cls = clauses[cid];
+
+    // 標記子句中的所有文字
+    litMarker.clear();
+    for (int i=0; i<cls.size(); ++i)
+        litMarker.set(cls.getVar(i), cls.getSign(i));
+
+    for (int i=0; i<cls.size(); ++i)
+    {
+        Lit lit = cls.getLit(i);
+        bool blocked = true;
+
+        // 與所有含有 -lit 的子句的解析式都必須是恆真式
+        for (int d : occurs[litNeg(lit)])
+        {
+            if (d == cid || eliminated[d])
+                continue;
+            const Clause &other = clauses[d];
+            bool taut = false;
+            for (int k=0; k<other.size() && !taut; ++k)
+            {
+                ++elimSteps;
+                Lit m = other.getLit(k);
+                taut = (m != litNeg(lit) && litMarker.get(litVar(m)) == !litSign(m));
+            }
+            if (!taut)
+            {
+                blocked = false;
+                break;
+            }
+        }
+        if (blocked)
+            return lit;
+    }
+    return 0;
+}
+
+
+/// @brief 以覆蓋文字擴充 (covered literal addition) 擴充子句，直到其被阻擋。
+/// @param cid 子句的 ID
+/// @param cover 擴充後的子句
+/// @param steps 每次擴充前的子句以及擴充所依據的文字，重建模型時需要
+/// @return 阻擋文字；若擴充後仍未被阻擋則回傳 0
+Lit solver::coverClause(int cid, vector<Lit> &cover, vector<ReconEntry> &steps)
+{
+    cover.assign(clauses[cid].begin(), clauses[cid].end());
+
+    litMarker.clear();
+    for (Lit lit : cover)
+        litMarker.set(litVar(lit), litSign(lit));
+
+    vector<Lit> cand;
+    for (size_t i=0; i<cover.size(); ++i)
+    {
+        if (elimSteps >= elimStepLimit || (int)cover.size() > coverSzLimit)
+            return 0;
+
+        Lit lit = cover[i];
+        int partners = 0;
+        cand.clear();
+        coverCnt.clear();
+
+        // 計算所有非恆真解析式共同擁有的文字
+        for (int d : occurs[litNeg(lit)])
+        {
+            if (d == cid || eliminated[d])
+                continue;
+            const Clause &other = clauses[d];
+            bool taut = false;
+            for (int k=0; k<other.size() && !taut; ++k)
+            {
+                ++elimSteps;
+                Lit m = other.getLit(k);
+                taut = (m != litNeg(lit) && litMarker.get(litVar(m)) == !litSign(m));
+            }
+            if (taut)
+                continue;
+
+            for (int k=0; k<other.size(); ++k)
+            {
+                Lit m = other.getLit(k);
+                if (m == litNeg(lit) || litMarker.get(litVar(m)) == litSign(m))
+                    continue;
+                if (partners == 0)
+                {
+                    if (coverCnt.get(m) == -1)
+                        cand.push_back(m);
+                    coverCnt.set(m, 1);
+                }
+                else if (coverCnt.get(m) == partners)
+                {
+                    coverCnt.set(m, partners+1);
+                }
+            }
+            ++partners;
+        }
+
+        // 所有解析式皆為恆真式：子句被 lit 阻擋
+        if (partners == 0)
+            return lit;
+
+        // 加入覆蓋文字，並記錄擴充前的子句
+        bool added = false;
+        for (Lit m : cand)
+        {
+            if (coverCnt.get(m) != partners)
+                continue;
+            if (!added)
+            {
+                steps.push_back({lit, cover});
+                added = true;
+            }
+            litMarker.set(litVar(m), litSign(m));
+            cover.push_back(m);
+        }
+    }
+    return 0;
+}
+
+
+/// @brief 依模型重建堆疊修正模型，使被刪除的子句也被滿足。
+/// @param model 模型，model[v] 為 v 或 -v
+void solver::extendModel(vector<int> &model) const
+{
+    for (int i=(int)reconStack.size()-1; i>=0; --i)
+    {
+        const ReconEntry &e = reconStack[i];
+        bool satisfied = false;
+        for (Lit lit : e.lit)
+        {
+            if (model[litVar(lit)] == toDimacs(lit))
+            {
+                satisfied = true;
+                break;
+            }
+        }
+        if (!satisfied)
+            model[litVar(e.witness)] = toDimacs(e.witness);
+    }
+}
@@ -0,0 +1,246 @@
+#include "solver.h"
+
+/******************************************************
+    All-solutions enumeration
+******************************************************/
+
+/// @brief 列舉所有解：每找到一個解就加入投影變數上的阻擋子句，並從原處繼續搜尋，
+///        保留學習子句與啟發式資訊。需在 init 之後呼叫，取代 solve。
+/// @param proj 投影變數（空的表示所有變數）；重複的變數只計一次，非正數的項目忽略
+/// @param numVars 宣告的變數數（p cnf 標頭）；大於 maxVarIndex 時，未出現在子句中的變數也是解的一部分
+/// @param limit 最多列舉的解數（0 表示不限）
+/// @param minimize 是否將解縮小成投影變數上的部分賦值，一次阻擋更多解
+/// @param onModel 每個解的回呼函式，參數為投影變數上的 DIMACS 文字（縮小後省略的變數不列出）；
+///        回傳 false 則停止列舉
+/// @return 找到的解（部分賦值）數量
+long long solver::enumerate(const vector<int> &proj, int numVars, long long limit, bool minimize,
+                            const function<bool(const vector<int> &)> &onModel)
+{
+    TRACE_SCOPE("enumerate");
+    time(&startTime);
+    projCount = 0;
+    enumComplete = false;
+
+    // 刪除被阻擋的子句會改變解的集合，列舉時不使用
+    runMode &= ~(BCE | CCE);
+    if( unsatAfterInit || !preprocess() || !initGauss() ) {
+        sat = 0;
+        enumComplete = true;
+        return 0;
+    }
+    initHeuristic();
+
+    // 沒有出現在任何子句中的投影變數（編號大於 maxVarIndex）不在求解器中，
+    // 可以任意取值：不列入解的輸出，每個這樣的變數使每個解代表的模型數加倍
+    vector<int> vars;
+    int freeVars = 0;
+    projIndex.assign(maxVarIndex+1, -1);
+    if (proj.empty())
+    {
+        for (int v = 1; v <= maxVarIndex; ++v) {
+            projIndex[v] = (int)vars.size();
+            vars.push_back(v);
+        }
+        freeVars = max(numVars - maxVarIndex, 0);
+    }
+    else
+    {
+        vector<int> seenFree;
+        for (int v : proj)
+        {
+            if (v <= 0)
+                continue;
+            if (v > maxVarIndex)
+                seenFree.push_back(v);
+            else if (projIndex[v] < 0) {
+                projIndex[v] = (int)vars.size();
+                vars.push_back(v);
+            }
+        }
+        sort(seenFree.begin(), seenFree.end());
+        freeVars = (int)(unique(seenFree.begin(), seenFree.end()) - seenFree.begin());
+    }
+
+    long long found = 0;
+    vector<Lit> block, decisions;
+    vector<int> cube;
+    while (limit <= 0 || found < limit)
+    {
+        if (!_solve()) {
+            enumComplete = runTime <= timeout;
+            break;
+        }
+        ++found;
+
+        // 解在投影變數上的（部分）賦值
+        block.clear();
+        if (minimize)
+            minimizeModel(vars, block);
+        else
+            for (int v : vars)
+                block.push_back(mkLit(v, var.getVal(v)));
+        cube.clear();
+        for (Lit l : block)
+            cube.push_back(toDimacs(l));
+        projCount += ldexpl(1.0L, (int)(vars.size() - block.size()) + freeVars);
+        if (!onModel(cube))
+            break;
+
+        // 決策變數都在投影集合中時，只需阻擋決策文字：其餘賦值都由傳播決定，
+        // 投影相同的解必定含有同樣的決策
+        if (!minimize)
+        {
+            bool onlyProj = true;
+            decisions.clear();
+            for (int i = 0; i <= var._top && onlyProj; ++i)
+            {
+                int v = litVar(var.at(i));
+                if (var.getLv(v) > 0 && var.getSrc(v) == -1) {
+                    onlyProj = projIndex[v] >= 0;
+                    decisions.push_back(var.at(i));
+                }
+            }
+            if (onlyProj)
+                block.swap(decisions);
+        }
+        for (Lit &l : block)
+            l = litNeg(l);
+        if (!addBlockingClause(block)) {
+            enumComplete = true;
+            break;
+        }
+    }
+    sat = found > 0;
+    return found;
+}
+
+
+/// @brief 在目前的完整賦值下加入阻擋子句（所有文字皆為假），
+///        回溯到子句成為單位子句的層級並傳播，與學習子句的處理方式相同。
+/// @param block 阻擋子句
+/// @return 若已沒有其他解則回傳 false；否則回傳 true
+bool solver::addBlockingClause(vector<Lit> &block)
+{
+    // 記錄完整的阻擋子句，供之後的模型最小化檢查
+    blockLits.insert(blockLits.end(), block.begin(), block.end());
+    blockLits.push_back(0);
+
+    // 第 0 層為假的文字不可能再被滿足
+    size_t j = 0;
+    for (Lit l : block)
+        if (var.getLv(litVar(l)) != 0)
+            block[j++] = l;
+    block.resize(j);
+    if (block.empty())
+        return false;
+
+    if (block.size() == 1)
+    {
+        backtrack(0);
+        nowLevel = 0;
+        if (!set(block[0]))
+            return false;
+        unit.emplace_back(block[0]);
+        return true;
+    }
+
+    // 層級最高的兩個文字作為觀察者
+    for (int w = 0; w < 2; ++w)
+    {
+        size_t best = w;
+        for (size_t i = w + 1; i < block.size(); ++i)
+            if (var.getLv(litVar(block[i])) > var.getLv(litVar(block[best])))
+                best = i;
+        swap(block[w], block[best]);
+    }
+    int lv0 = var.getLv(litVar(block[0]));
+    int lv1 = var.getLv(litVar(block[1]));
+
+    int cid = newClause(block.data(), (int)block.size());
+    clauses[cid].watcher[0] = 0;
+    clauses[cid].watcher[1] = 1;
+    clauses[cid].lbd = (int)block.size();
+    watchers.resize(watchers.size()+2);
+    initWatcherList(cid);
+
+    // 兩個觀察文字在同一層：回溯到前一層後兩者皆未賦值
+    if (lv0 == lv1)
+    {
+        backtrack(lv0 - 1);
+        nowLevel = lv0 - 1;
+        return true;
+    }
+    backtrack(lv1);
+    nowLevel = lv1;
+    return assignLearn(block[0], cid);
+}
+
+
+/// @brief 將目前的解縮小成投影變數上的部分賦值：在其餘變數固定的情況下，
+///        若省略某個投影變數後每個原始子句與阻擋子句仍有固定為真的文字，就省略它。
+///        省略的變數不論取何值都是解，且與先前的部分賦值不相交。
+/// @param proj 投影變數
+/// @param cube 保留的（為真的）文字
+void solver::minimizeModel(const vector<int> &proj, vector<Lit> &cube)
+{
+    int np = (int)proj.size();
+    int nb = 0;
+    for (Lit l : blockLits)
+        nb += (l == 0);
+    int nc = oriClsNum + nb;
+    minTrue.assign(nc, 0);
+    minOccStart.assign(np + 1, 0);
+
+    // 第一遍：計算每個子句的真文字數，以及每個投影變數的真文字出現次數
+    auto scan = [&](bool fill) {
+        int c = 0;
+        auto visit = [&](Lit l) {
+            if (var.litVal(l) != 1)
+                return;
+            int p = projIndex[litVar(l)];
+            if (!fill) {
+                ++minTrue[c];
+                if (p >= 0)
+                    ++minOccStart[p + 1];
+            }
+            else if (p >= 0) {
+                minOcc[minOccStart[p]++] = c;
+            }
+        };
+        for (; c < oriClsNum; ++c)
+            for (Lit l : clauses[c])
+                visit(l);
+        for (Lit l : blockLits)
+        {
+            if (l == 0)
+                ++c;
+            else
+                visit(l);
+        }
+    };
+    scan(false);
+    for (int i = 0; i < np; ++i)
+        minOccStart[i + 1] += minOccStart[i];
+    minOcc.resize(minOccStart[np]);
+    // 第二遍填入出現列表（填完後 minOccStart[i] 變成第 i 個列表的結尾）
+    scan(true);
+
+    for (int i = 0; i < np; ++i)
+    {
+        int v = proj[i];
+        Lit lit = mkLit(v, var.getVal(v));
+        int begin = i ? minOccStart[i - 1] : 0, end = minOccStart[i];
+
+        // 第 0 層的賦值（其滿足的子句可能已被刪除）與基數約束中的變數必須保留
+        bool keep = var.getLv(v) == 0 ||
+            (!cardOcc.empty() && (!cardOcc[lit].empty() || !cardOcc[litNeg(lit)].empty()));
+        for (int k = begin; k < end && !keep; ++k)
+            keep = minTrue[minOcc[k]] == 1;
+        if (keep) {
+            cube.push_back(lit);
+            continue;
+        }
+        for (int k = begin; k < end; ++k)
+            --minTrue[minOcc[k]];
+    }
+}
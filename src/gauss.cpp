@@ -0,0 +1,483 @@
+#include "solver.h"
+
+/******************************************************
+    XOR constraints & Gauss-Jordan elimination
+******************************************************/
+
+// 與取樣器相同，只有 x86-64 才提供 AVX2 版本的列運算
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  include <immintrin.h>
+#  define GAUSS_AVX2 1
+#  define GAUSS_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#  include <immintrin.h>
+#  include <intrin.h>
+#  define GAUSS_AVX2 1
+#  define GAUSS_TARGET_AVX2
+#else
+#  define GAUSS_AVX2 0
+#endif
+
+
+static inline int popcount64(uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    int c = 0;
+    for (; x; x &= x - 1)
+        ++c;
+    return c;
+#endif
+}
+
+static inline int lowestBit(uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int i = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        ++i;
+    }
+    return i;
+#endif
+}
+
+
+/// @brief dst ^= src（純量版本）
+static void rowXorScalar(uint64_t *dst, const uint64_t *src, int words)
+{
+    for (int i = 0; i < words; ++i)
+        dst[i] ^= src[i];
+}
+
+#if GAUSS_AVX2
+/// @brief dst ^= src（AVX2 版本，一次處理 256 位元）
+GAUSS_TARGET_AVX2
+static void rowXorAVX2(uint64_t *dst, const uint64_t *src, int words)
+{
+    int i = 0;
+    for (; i + 4 <= words; i += 4)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(dst + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(a, b));
+    }
+    for (; i < words; ++i)
+        dst[i] ^= src[i];
+}
+#endif
+
+
+/// @brief 從原始子句中還原 XOR 約束：k 個變數的 XOR 以 2^(k-1) 個子句編碼，
+///        每個子句排除一組奇偶性錯誤的賦值。需在刪除子句之前呼叫。
+void solver::recoverXors()
+{
+    TRACE_SCOPE("recoverXors");
+    xorCand.clear();
+    xorCandRhs.clear();
+
+    // 只考慮沒有重複變數、大小在範圍內的子句；文字排序後依變數集合分組
+    // （不能直接排序子句本身，觀察者記錄的是文字位置）
+    vector<vector<Lit>> cand;
+    for (int cid = 0; cid < oriClsNum; ++cid)
+    {
+        const Clause &cls = clauses[cid];
+        if (cls.size() < 3 || cls.size() > maxXorSize)
+            continue;
+        vector<Lit> lits(cls.begin(), cls.end());
+        sort(lits.begin(), lits.end());
+        bool distinct = true;
+        for (size_t i = 1; i < lits.size() && distinct; ++i)
+            distinct = litVar(lits[i]) != litVar(lits[i-1]);
+        if (distinct)
+            cand.push_back(move(lits));
+    }
+    auto sameVars = [](const vector<Lit> &x, const vector<Lit> &y) {
+        if (x.size() != y.size())
+            return false;
+        for (size_t i = 0; i < x.size(); ++i)
+            if (litVar(x[i]) != litVar(y[i]))
+                return false;
+        return true;
+    };
+    sort(cand.begin(), cand.end(), [](const vector<Lit> &x, const vector<Lit> &y) {
+        if (x.size() != y.size())
+            return x.size() < y.size();
+        return x < y;
+    });
+
+    for (size_t i = 0, j; i < cand.size(); i = j)
+    {
+        j = i + 1;
+        while (j < cand.size() && sameVars(cand[i], cand[j]))
+            ++j;
+        int k = (int)cand[i].size();
+        if ((int)(j - i) < (1 << (k-1)))
+            continue;
+
+        // 第 b 位元表示第 b 個文字為負；子句排除的賦值正好是該遮罩
+        uint64_t seen = 0;
+        for (size_t t = i; t < j; ++t)
+        {
+            int mask = 0;
+            for (int b = 0; b < k; ++b)
+                mask |= (!litSign(cand[t][b])) << b;
+            seen |= 1ULL << mask;
+        }
+        for (int parity = 0; parity < 2; ++parity)
+        {
+            bool full = true;
+            for (int mask = 0; mask < (1 << k) && full; ++mask)
+                if ((popcount64((uint64_t)mask) & 1) == parity)
+                    full = (seen >> mask) & 1;
+            if (!full)
+                continue;
+            // 所有奇偶性為 parity 的賦值都被排除：變數的 XOR 為 parity^1
+            vector<int> vars(k);
+            for (int b = 0; b < k; ++b)
+                vars[b] = litVar(cand[i][b]);
+            xorCand.push_back(move(vars));
+            xorCandRhs.push_back((char)(parity ^ 1));
+        }
+    }
+    xorsFound = (int)xorCand.size();
+}
+
+
+/// @brief 以還原的 XOR 約束建立矩陣並進行高斯-喬登消去，接著處理第 0 層的賦值。
+/// @return 若發現問題不可滿足則回傳 false；否則回傳 true。
+bool solver::initGauss()
+{
+    TRACE_SCOPE("initGauss");
+    gaussActive = false;
+    if (xorCand.empty())
+        return true;
+
+#if GAUSS_AVX2
+    rowXor = BitSampler::cpuHasAVX2() ? rowXorAVX2 : rowXorScalar;
+#else
+    rowXor = rowXorScalar;
+#endif
+
+    // 只有出現在 XOR 中的變數才佔用矩陣的行
+    colOfVar.assign(maxVarIndex+1, -1);
+    varOfCol.clear();
+    for (auto &x : xorCand)
+        for (int v : x)
+            if (colOfVar[v] < 0) {
+                colOfVar[v] = (int)varOfCol.size();
+                varOfCol.push_back(v);
+            }
+    xorCols = (int)varOfCol.size();
+    xorWords = (xorCols + 63) >> 6;
+
+    int m = (int)xorCand.size();
+    xorMat.assign((size_t)m * xorWords, 0);
+    xorRhs.assign(xorCandRhs.begin(), xorCandRhs.end());
+    for (int r = 0; r < m; ++r)
+        for (int v : xorCand[r]) {
+            int c = colOfVar[v];
+            rowPtr(r)[c >> 6] ^= 1ULL << (c & 63);
+        }
+    vector<vector<int>>().swap(xorCand);
+    vector<char>().swap(xorCandRhs);
+
+    // 高斯-喬登消去：每個基本變數只出現在自己的列
+    basicOf.clear();
+    rowOfBasic.assign(xorCols, -1);
+    int rank = 0;
+    for (int c = 0; c < xorCols && rank < m; ++c)
+    {
+        int w = c >> 6;
+        uint64_t bit = 1ULL << (c & 63);
+        int p = rank;
+        while (p < m && !(rowPtr(p)[w] & bit))
+            ++p;
+        if (p == m)
+            continue;
+        if (p != rank) {
+            swap_ranges(rowPtr(p), rowPtr(p) + xorWords, rowPtr(rank));
+            swap(xorRhs[p], xorRhs[rank]);
+        }
+        for (int r = 0; r < m; ++r)
+            if (r != rank && (rowPtr(r)[w] & bit)) {
+                rowXor(rowPtr(r), rowPtr(rank), xorWords);
+                xorRhs[r] ^= xorRhs[rank];
+            }
+        basicOf.push_back(c);
+        rowOfBasic[c] = rank;
+        ++rank;
+    }
+    // 其餘的列都已為空：0 = 1 表示不可滿足
+    for (int r = rank; r < m; ++r)
+        if (xorRhs[r])
+            return false;
+    xorMat.resize((size_t)rank * xorWords);
+    xorRhs.resize(rank);
+
+    colBasic.assign(xorWords, 0);
+    for (int c : basicOf)
+        colBasic[c >> 6] |= 1ULL << (c & 63);
+    colAssigned.assign(xorWords, 0);
+    colValue.assign(xorWords, 0);
+    nbWatch.assign(rank, -1);
+    colWatch.assign(xorCols, vector<int>());
+    xorReasonPos.assign(maxVarIndex+1, 0);
+    gaussWork.clear();
+    gaussRecheck.clear();
+    gaussHead = 0;
+    gaussCol = -1;
+    gaussActive = true;
+
+    // 為每一列設定觀察者；只有基本變數的列直接在第 0 層傳播
+    inGauss = true;
+    gaussConflict = false;
+    for (int r = 0; r < rank; ++r)
+        fixRow(r);
+    inGauss = false;
+    if (gaussConflict)
+        return false;
+    return gaussPropagate();
+}
+
+
+/// @brief 處理軌跡上尚未被高斯引擎處理的賦值
+/// @return 若沒有衝突則回傳 true；否則回傳 false（conflictingClsID 指示衝突來源）
+bool solver::gaussPropagate()
+{
+    inGauss = true;
+    gaussConflict = false;
+
+    // 回溯撤銷了基本變數、但其餘變數仍已賦值的列現在是單位列
+    if (!gaussRecheck.empty())
+    {
+        gaussCol = -1;
+        gaussWork.swap(gaussRecheck);
+        gaussRecheck.clear();
+        for (size_t i = 0; i < gaussWork.size(); ++i)
+            fixRow(gaussWork[i]);
+    }
+    while (gaussHead <= var._top && !gaussConflict)
+    {
+        Lit lit = var.at(gaussHead++);
+        int col = colOfVar[litVar(lit)];
+        if (col < 0)
+            continue;
+        colAssigned[col >> 6] |= 1ULL << (col & 63);
+        if (litSign(lit))
+            colValue[col >> 6] |= 1ULL << (col & 63);
+        gaussAssign(col);
+    }
+    inGauss = false;
+    return !gaussConflict;
+}
+
+
+/// @brief 修正以該行為基本變數或觀察變數的所有列
+/// @param col 剛被賦值的行
+/// @return 若沒有衝突則回傳 true；否則回傳 false
+bool solver::gaussAssign(int col)
+{
+    gaussCol = col;
+    gaussWork.clear();
+    if (rowOfBasic[col] >= 0)
+        gaussWork.push_back(rowOfBasic[col]);
+    for (int r : colWatch[col])
+        if (nbWatch[r] == col)
+            gaussWork.push_back(r);
+    colWatch[col].clear();
+
+    // 換軸時會加入更多待修正的列
+    for (size_t i = 0; i < gaussWork.size(); ++i)
+        fixRow(gaussWork[i]);
+    gaussCol = -1;
+    return !gaussConflict;
+}
+
+
+/// @brief 讓列維持兩個未賦值的觀察變數（基本變數與一個非基本變數）；
+///        做不到時推導基本變數的值或檢查奇偶性。發生衝突後只維護觀察者。
+/// @param r 列
+/// @return 若沒有衝突則回傳 true；否則回傳 false
+bool solver::fixRow(int r)
+{
+    const uint64_t *row = rowPtr(r);
+    int b = basicOf[r];
+
+    // 基本變數已賦值：換軸到一個未賦值的非基本變數
+    if (colAssigned[b >> 6] >> (b & 63) & 1)
+    {
+        for (int w = 0; w < xorWords; ++w)
+        {
+            uint64_t freeBits = row[w] & ~colAssigned[w] & ~colBasic[w];
+            if (freeBits) {
+                pivotRow(r, (w << 6) + lowestBit(freeBits));
+                b = basicOf[r];
+                break;
+            }
+        }
+    }
+
+    // 保留或尋找一個未賦值的非基本觀察變數
+    int c = nbWatch[r];
+    if (c >= 0 && (row[c >> 6] >> (c & 63) & 1) && !(colBasic[c >> 6] >> (c & 63) & 1) &&
+        !(colAssigned[c >> 6] >> (c & 63) & 1))
+        return true;
+    for (int w = 0; w < xorWords; ++w)
+    {
+        uint64_t freeBits = row[w] & ~colAssigned[w] & ~colBasic[w];
+        if (freeBits) {
+            setRowWatch(r, (w << 6) + lowestBit(freeBits));
+            return true;
+        }
+    }
+
+    // 非基本變數皆已賦值：觀察層級最高的兩個變數（含基本變數），並讓層級最高者成為基本變數。
+    // 回溯越過兩者時此列再有兩個未賦值變數；只撤銷基本變數時由 gaussRecheck 重新推導
+    int top = -1, topLv = -1, second = -1, secondLv = -1;
+    for (int w = 0; w < xorWords; ++w)
+    {
+        uint64_t bits = row[w] & ~colBasic[w];
+        while (bits)
+        {
+            int k = (w << 6) + lowestBit(bits);
+            bits &= bits - 1;
+            int lv = var.getLv(varOfCol[k]);
+            if (lv > topLv) {
+                second = top;
+                secondLv = topLv;
+                topLv = lv;
+                top = k;
+            } else if (lv > secondLv) {
+                secondLv = lv;
+                second = k;
+            }
+        }
+    }
+    bool basicAssigned = colAssigned[b >> 6] >> (b & 63) & 1;
+    if (basicAssigned && var.getLv(varOfCol[b]) < topLv)
+    {
+        // 基本變數的層級較低：換軸到層級最高的變數，原基本變數改為候選觀察變數
+        pivotRow(r, top);
+        if (var.getLv(varOfCol[b]) > secondLv)
+            second = b;
+        top = second;
+    }
+    if (top >= 0)
+        setRowWatch(r, top);
+
+    if (gaussConflict) {
+        // 此列可能正是單位列：回溯後再推導
+        if (!basicAssigned)
+            gaussRecheck.push_back(r);
+        return true;
+    }
+    return gaussImply(r);
+}
+
+
+/// @brief 以第 r 列消去其他列中的 col，使 col 成為第 r 列的基本變數
+void solver::pivotRow(int r, int col)
+{
+    int w = col >> 6;
+    uint64_t bit = 1ULL << (col & 63);
+    const uint64_t *src = rowPtr(r);
+    int m = (int)basicOf.size();
+    for (int s = 0; s < m; ++s)
+    {
+        if (s == r || !(rowPtr(s)[w] & bit))
+            continue;
+        rowXor(rowPtr(s), src, xorWords);
+        xorRhs[s] ^= xorRhs[r];
+        gaussWork.push_back(s);
+    }
+    int old = basicOf[r];
+    colBasic[old >> 6] &= ~(1ULL << (old & 63));
+    colBasic[w] |= bit;
+    rowOfBasic[old] = -1;
+    rowOfBasic[col] = r;
+    basicOf[r] = col;
+}
+
+
+/// @brief 設定列的非基本觀察變數
+void solver::setRowWatch(int r, int col)
+{
+    // 正在處理的行的觀察列表已被清空，需要重新加入
+    if (nbWatch[r] != col || col == gaussCol)
+        colWatch[col].push_back(r);
+    nbWatch[r] = col;
+}
+
+
+/// @brief 列中除基本變數外皆已賦值：推導基本變數的值，或在基本變數已賦值時檢查奇偶性
+/// @param r 列
+/// @return 若沒有衝突則回傳 true；否則回傳 false
+bool solver::gaussImply(int r)
+{
+    const uint64_t *row = rowPtr(r);
+    int b = basicOf[r];
+    int parity = xorRhs[r];
+    for (int w = 0; w < xorWords; ++w)
+        parity ^= popcount64(row[w] & colValue[w] & ~colBasic[w]) & 1;
+
+    // parity 為基本變數應有的值
+    int v = varOfCol[b];
+    Lit lit = mkLit(v, parity);
+    int val = var.litVal(lit);
+    if (val == 1)
+        return true;
+    if (val == 0)
+    {
+        xorConflict.clear();
+        rowExplain(r, -1, xorConflict);
+        conflictingClsID = XOR_CONFLICT;
+        gaussConflict = true;
+        ++gaussConflicts;
+        return false;
+    }
+
+    // 解釋子句：[長度, lit, 其他變數目前賦值的反文字]
+    if (nowLevel > 0)
+    {
+        size_t pos = xorExpl.size();
+        xorExpl.push_back(0);
+        xorExpl.push_back(lit);
+        rowExplain(r, b, xorExpl);
+        xorExpl[pos] = (Lit)(xorExpl.size() - pos - 1);
+        xorReasonPos[v] = (int)pos;
+    }
+    ++gaussProps;
+    if (!set(lit, XOR_REASON))
+    {
+        gaussConflict = true;
+        return false;
+    }
+    return true;
+}
+
+
+/// @brief 將列中已賦值變數的反文字加入 out（整個子句在目前賦值下為假）
+/// @param r 列
+/// @param skipCol 略過的行（-1 表示不略過）
+/// @param out 輸出
+void solver::rowExplain(int r, int skipCol, vector<Lit> &out)
+{
+    const uint64_t *row = rowPtr(r);
+    for (int w = 0; w < xorWords; ++w)
+    {
+        uint64_t bits = row[w];
+        while (bits)
+        {
+            int k = (w << 6) + lowestBit(bits);
+            bits &= bits - 1;
+            if (k == skipCol)
+                continue;
+            int v = varOfCol[k];
+            out.push_back(mkLit(v, !var.getVal(v)));
+        }
+    }
+}
@@ -42,3 +42,49 @@ void VarHeap::downward(int id) {
         }
     }
 }
+
+/// @brief 取出堆積的完整狀態
+void VarHeap::save(State &st) const
+{
+    st.nowT = nowT;
+    st.sz = sz;
+    st.pri.resize(arr.size());
+    st.var.resize(arr.size());
+    st.lastEvalT.resize(arr.size());
+    for (size_t i = 0; i < arr.size(); ++i)
+    {
+        st.pri[i] = arr[i].pri;
+        st.var[i] = arr[i].var;
+        st.lastEvalT[i] = arr[i].lastEvalT;
+    }
+    st.signCnt = signCnt;
+}
+
+/// @brief 還原堆積的狀態（需先以相同的變數數量 init）
+/// @return 狀態與目前的大小不符，或位置 1..fullSz 不是變數的排列時回傳 false，堆積不變
+bool VarHeap::load(const State &st)
+{
+    size_t n = arr.size();
+    if (st.pri.size() != n || st.var.size() != n || st.lastEvalT.size() != n ||
+        st.signCnt.size() != n || st.sz < 0 || st.sz > fullSz)
+        return false;
+    vector<char> seen(fullSz + 1, 0);
+    for (int i = 1; i <= fullSz; ++i)
+    {
+        int v = st.var[i];
+        if (v < 1 || v > fullSz || seen[v])
+            return false;
+        seen[v] = 1;
+    }
+    nowT = st.nowT;
+    sz = st.sz;
+    for (size_t i = 0; i < n; ++i)
+    {
+        arr[i] = HeapEntry(st.pri[i], st.var[i]);
+        arr[i].lastEvalT = st.lastEvalT[i];
+    }
+    for (int i = 1; i <= fullSz; ++i)
+        mapping[arr[i].var] = i;
+    signCnt = st.signCnt;
+    return true;
+}
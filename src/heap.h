@@ -23,7 +23,21 @@ public:
     inline void restore(int var);
     inline void increasePri(int var, double pri, int sign);
     inline void decayAll();
-    constexpr static const double decayFactor = 0.9;
+    template<class F> void forEachBuffer(F f) const;
+    double decayFactor = 0.9;       ///< 優先級的衰減係數
+
+    // 堆積的完整狀態（陣列依堆積位置），用於求解狀態快照
+    struct State
+    {
+        int nowT = 0;
+        int sz = 0;
+        vector<double> pri;
+        vector<int> var;
+        vector<int> lastEvalT;
+        vector<int> signCnt;
+    };
+    void save(State &st) const;
+    bool load(const State &st);
 
 protected:
     struct HeapEntry
@@ -87,6 +101,15 @@ inline void VarHeap::decayAll()
     ++nowT;
 }
 
+/// @brief 對每個內部陣列呼叫 f(起始位址, 位元組數)
+template<class F>
+void VarHeap::forEachBuffer(F f) const
+{
+    f((const void *)arr.data(), arr.capacity() * sizeof(HeapEntry));
+    f((const void *)signCnt.data(), signCnt.capacity() * sizeof(int));
+    f((const void *)mapping.data(), mapping.capacity() * sizeof(int));
+}
+
 /// @brief 交換兩個堆元素的位置
 /// @param aid 第一個元素的索引
 /// @param bid 第二個元素的索引
@@ -0,0 +1,312 @@
+#include "solver.h"
+
+/******************************************************
+    Inprocessing
+******************************************************/
+
+/// @brief 對高價值的學習子句進行 vivification，需在第 0 層呼叫。
+/// @return 若發現問題不可滿足則回傳 false；否則回傳 true。
+bool solver::vivifyLearnts()
+{
+    TRACE_SCOPE("vivify");
+    // 傳播預算：自上次 vivification 以來搜尋傳播數的一定比例
+    long long budget = (propagations - lastVivifyProps) * params.vivifyEffort / 100;
+    long long limit = propagations + max(budget, 10000LL);
+
+    // 選出尚未處理過、LBD 夠小的學習子句，LBD 小者優先
+    vivifyCand.clear();
+    for (int cid = oriClsNum; cid < (int)clauses.size(); ++cid)
+    {
+        if (!clauses[cid].vivified && clauses[cid].lbd <= params.vivifyLbdLimit)
+            vivifyCand.push_back(cid);
+    }
+    // 以子句 ID 作為次要鍵，不需要 stable_sort 的暫存空間
+    sort(vivifyCand.begin(), vivifyCand.end(), [this](int a, int b) {
+        return clauses[a].lbd < clauses[b].lbd ||
+               (clauses[a].lbd == clauses[b].lbd && a < b);
+    });
+
+    for (int cid : vivifyCand)
+    {
+        if (propagations >= limit)
+            break;
+        int removed = vivifyClause(cid);
+        if (removed < 0)
+            return false;
+        vivifiedLits += removed;
+    }
+
+    lastVivifyProps = propagations;
+    nextVivify = conflicts + params.vivifyInterval;
+    return true;
+}
+
+
+/// @brief 依序指派子句文字的反值並傳播，刪除被蘊含或導致衝突後多餘的文字。
+/// @param cid 子句的 ID
+/// @return 刪除的文字數；若發現問題不可滿足則回傳 -1
+int solver::vivifyClause(int cid)
+{
+    Clause &cls = clauses[cid];
+    cls.vivified = true;
+
+    // 已在第 0 層被滿足的子句不需處理
+    for (int i=0; i<cls.size(); ++i)
+    {
+        if (var.litVal(cls.getLit(i)) == 1 && var.getLv(cls.getVar(i)) == 0)
+            return 0;
+    }
+
+    vivifyKept.clear();
+    for (int i=0; i<cls.size(); ++i)
+    {
+        Lit lit = cls.getLit(i);
+        int val = var.litVal(lit);
+
+        if (val == 2)
+        {
+            // 在新的決策層級指派文字的反值
+            vivifyKept.push_back(lit);
+            ++nowLevel;
+            if (!set(litNeg(lit)))
+            {
+                if (solveDone)
+                    vivifyKept.assign(cls.begin(), cls.end());
+                break;
+            }
+        }
+        else if (val == 1)
+        {
+            // 文字被先前的反值蘊含為真，其後的文字皆可刪除
+            vivifyKept.push_back(lit);
+            if (var.getSrc(litVar(lit)) != cid)
+                break;
+        }
+        // 文字被蘊含為假，可直接刪除
+    }
+
+    backtrack(0);
+    nowLevel = 0;
+
+    int removed = cls.size() - (int)vivifyKept.size();
+    if (removed == 0)
+        return 0;
+
+    if (vivifyKept.empty())
+        return -1;
+    if (proof)
+        proof->add(vivifyKept);
+
+    // 學到單位子句：在第 0 層賦值，原子句之後恆被滿足
+    if (vivifyKept.size() == 1)
+    {
+        Lit lit = vivifyKept[0];
+        if (!set(lit))
+            return -1;
+        unit.emplace_back(lit);
+        return removed;
+    }
+
+    // 以縮短後的子句重新建立觀察者
+    if (proof)
+        proof->del(cls.lit, cls.size());
+    detachClause(cid);
+    // 縮短後的子句直接覆寫在原本的空間上
+    copy(vivifyKept.begin(), vivifyKept.end(), cls.lit);
+    cls.sz = (int)vivifyKept.size();
+    cls.watcher[0] = 0;
+    cls.watcher[1] = (cls.size() >> 1);
+    cls.lbd = min(cls.lbd, cls.size());
+    initWatcherList(cid);
+    return removed;
+}
+
+
+/// @brief 以目前儲存的相位為起點執行有限翻轉次數的局部搜尋，
+///        並以找到的最佳賦值覆寫儲存的相位，需在第 0 層呼叫。
+void solver::rephaseLocalSearch()
+{
+    TRACE_SCOPE("rephase");
+    localSearch.init(maxVarIndex, nextRand());
+
+    // 只使用原始子句；第 0 層的賦值以單位子句的形式加入
+    vector<int> cls;
+    for (int cid = 0; cid < oriClsNum; ++cid)
+    {
+        cls.clear();
+        for (Lit lit : clauses[cid])
+            cls.push_back(toDimacs(lit));
+        localSearch.addClause(cls);
+    }
+    for (int i = 0; i <= var._top; ++i)
+    {
+        int lit = toDimacs(var.at(i));
+        localSearch.addClause(&lit, 1);
+    }
+
+    vector<char> phase(maxVarIndex+1, 0);
+    for (int v = 1; v <= maxVarIndex; ++v)
+        phase[v] = (char)phaseRecord[v];
+    localSearch.setPhases(phase);
+    localSearch.solve(params.rephaseFlips, 0);
+
+    const vector<char> &best = localSearch.getBestAssign();
+    for (int v = 1; v <= maxVarIndex; ++v)
+        phaseRecord[v] = best[v];
+
+    lsBestUnsat = localSearch.getBestUnsatCount();
+    ++rephases;
+    nextRephase = conflicts + params.rephaseInterval * rephases;
+}
+
+
+/// @brief 以位元平行的隨機取樣挑選不滿足子句數最少的賦值作為初始相位，需在第 0 層呼叫。
+void solver::samplePhases()
+{
+    TRACE_SCOPE("samplePhases");
+    BitSampler sampler;
+    sampler.init(maxVarIndex, nextRand());
+
+    // 只使用原始子句；第 0 層的賦值直接固定
+    vector<int> cls;
+    for (int cid = 0; cid < oriClsNum; ++cid)
+    {
+        cls.clear();
+        for (Lit lit : clauses[cid])
+            cls.push_back(toDimacs(lit));
+        sampler.addClause(cls);
+    }
+    for (int i = 0; i <= var._top; ++i)
+        sampler.fix(litVar(var.at(i)), litSign(var.at(i)));
+
+    vector<char> best;
+    sampleBestUnsat = sampler.sample(params.sampleRounds, best);
+    sampled += sampler.evaluated;
+    for (int v = 1; v <= maxVarIndex; ++v)
+        phaseRecord[v] = best[v];
+}
+
+
+/// @brief 刪除在第 0 層已被滿足的子句，並移除為假的文字，需在第 0 層、傳播完成後呼叫。
+///        觀察者列表以遞增方式維護：只移除被刪除子句的觀察者，並重新連結被搬移子句的觀察者。
+void solver::simplifyDB()
+{
+    TRACE_SCOPE("simplifyDB");
+    // 先把新的第 0 層賦值寫成單位子句，刪除它們的來源子句後證明仍可檢查
+    if (proof)
+    {
+        for (int i = simpTrail; i <= var._top; ++i)
+        {
+            Lit lit = var.at(i);
+            proof->add(&lit, 1);
+        }
+    }
+
+    int n = (int)clauses.size();
+    int j = 0, newOriClsNum = 0;
+    long long lits = 0;
+    for (int cid = 0; cid < n; ++cid)
+    {
+        Clause &cls = clauses[cid];
+        bool satisfied = false, hasFalse = false;
+        for (Lit lit : cls)
+        {
+            int val = var.litVal(lit);
+            if (val == 1) {
+                satisfied = true;
+                break;
+            }
+            hasFalse |= (val == 0);
+        }
+
+        if (satisfied)
+        {
+            if (proof)
+                proof->del(cls.lit, cls.size());
+            detachClause(cid);
+            ++simpRemovedCls;
+            continue;
+        }
+
+        if (hasFalse)
+        {
+            if (proof)
+                proofTmp.assign(cls.begin(), cls.end());
+
+            // 傳播完成後未被滿足的子句，觀察的文字都不為假，只需更新其位置；
+            // 若不是如此則重新建立觀察者
+            bool rewatch = var.litVal(cls.getWatchLit(0)) == 0 ||
+                           var.litVal(cls.getWatchLit(1)) == 0;
+            if (rewatch)
+                detachClause(cid);
+            int k = 0;
+            int w0 = -1, w1 = -1;
+            for (int i = 0; i < cls.size(); ++i)
+            {
+                if (var.litVal(cls.lit[i]) == 0)
+                    continue;
+                if (i == cls.watcher[0])
+                    w0 = k;
+                if (i == cls.watcher[1])
+                    w1 = k;
+                cls.lit[k++] = cls.lit[i];
+            }
+            simpRemovedLits += cls.size() - k;
+            cls.sz = k;
+            cls.watcher[0] = rewatch ? 0 : w0;
+            cls.watcher[1] = rewatch ? (k >> 1) : w1;
+            if (proof)
+            {
+                proof->add(cls.lit, k);
+                proof->del(proofTmp);
+            }
+            if (rewatch)
+                initWatcherList(cid);
+        }
+
+        if (j != cid)
+            moveClause(cid, j);
+        if (cid < oriClsNum)
+            ++newOriClsNum;
+        lits += clauses[j].size();
+        ++j;
+    }
+    clauses.resize(j);
+    watchers.resize((size_t)j << 1);
+    oriClsNum = newOriClsNum;
+
+    // 傳播數超過資料庫的文字數之後才再次簡化
+    ++simplifies;
+    simpTrail = var._top + 1;
+    nextSimplify = propagations + lits;
+}
+
+
+/// @brief 將子句搬移到較前面的空位，並重新連結它的兩個觀察者。
+/// @param from 原本的子句 ID
+/// @param to 新的子句 ID（原本的子句已被刪除或搬走）
+void solver::moveClause(int from, int to)
+{
+    clauses[to] = clauses[from];
+    for (int wid = 0; wid < 2; ++wid)
+    {
+        int a = (from << 1) + wid;
+        int b = (to << 1) + wid;
+        WatcherInfo &w = watchers[b];
+        w = watchers[a];
+        w.clsid = to;
+        if (w.next == a)
+        {
+            // 列表中只有這個觀察者
+            w.next = w.prev = b;
+        }
+        else
+        {
+            watchers[w.prev].next = b;
+            watchers[w.next].prev = b;
+        }
+        int &head = watchHead[clauses[to].getWatchLit(wid)];
+        if (head == a)
+            head = b;
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef __LITERAL_H
+#define __LITERAL_H
+
+#include <cstdlib>
+using namespace std;
+
+
+// 文字以 2*var+sign 編碼（sign 為 1 表示正文字），反文字只需將最低位元取反，
+// 並可直接作為每個文字的陣列索引。
+typedef unsigned int Lit;
+
+/// @brief 由變數與正負號建立文字
+inline Lit mkLit(int vid, int sign)
+{
+    return ((Lit)vid << 1) | (Lit)(sign != 0);
+}
+
+/// @brief 將 DIMACS 文字（有號整數）轉為編碼後的文字
+inline Lit toLit(int dimacs)
+{
+    return mkLit(abs(dimacs), dimacs > 0);
+}
+
+/// @brief 將編碼後的文字轉回 DIMACS 文字
+inline int toDimacs(Lit lit)
+{
+    return (lit & 1) ? (int)(lit >> 1) : -(int)(lit >> 1);
+}
+
+inline int litVar(Lit lit)
+{
+    return (int)(lit >> 1);
+}
+
+inline int litSign(Lit lit)
+{
+    return (int)(lit & 1);
+}
+
+inline Lit litNeg(Lit lit)
+{
+    return lit ^ 1;
+}
+
+#endif
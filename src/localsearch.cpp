@@ -0,0 +1,315 @@
+#include "localsearch.h"
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+/// @brief 初始化局部搜尋
+/// @param maxVarIndex 最大變數索引
+/// @param seed 亂數種子
+void LocalSearch::init(int maxVarIndex, uint64_t seed)
+{
+    *this = LocalSearch();
+    maxVar = maxVarIndex;
+    rng = seed ? seed : 1;
+    clsStart.push_back(0);
+}
+
+
+/// @brief 加入一個子句（重複文字會被合併，恆真子句會被忽略）
+/// @param lit 子句文字
+/// @param n 文字數量
+void LocalSearch::addClause(const int *lit, int n)
+{
+    size_t begin = lits.size();
+    for (int i=0; i<n; ++i)
+    {
+        bool dup = false;
+        for (size_t j=begin; j<lits.size(); ++j)
+        {
+            if (lits[j] == -lit[i]) {
+                lits.resize(begin);
+                return;
+            }
+            dup |= (lits[j] == lit[i]);
+        }
+        if (!dup)
+            lits.push_back(lit[i]);
+    }
+    maxClsSize = max(maxClsSize, (int)(lits.size() - begin));
+    clsStart.push_back((int)lits.size());
+    built = false;
+}
+
+void LocalSearch::addClause(const vector<int> &cls)
+{
+    addClause(cls.data(), (int)cls.size());
+}
+
+
+/// @brief 指定初始賦值（取代第一次嘗試的隨機賦值）
+/// @param phase phase[v] 為變數 v 的初始值
+void LocalSearch::setPhases(const vector<char> &phase)
+{
+    assign.assign(maxVar+1, 0);
+    for (int v=1; v<=maxVar && v<(int)phase.size(); ++v)
+        assign[v] = phase[v] ? 1 : 0;
+    hasPhases = true;
+}
+
+
+/// @brief 建立文字出現列表與搜尋狀態的空間
+void LocalSearch::build()
+{
+    int numCls = (int)clsStart.size() - 1;
+    occStart.assign(((maxVar+1) << 1) + 1, 0);
+    for (int lit : lits)
+        ++occStart[litIdx(lit) + 1];
+    for (size_t i=1; i<occStart.size(); ++i)
+        occStart[i] += occStart[i-1];
+    occ.assign(lits.size(), 0);
+    vector<int> next(occStart.begin(), occStart.end() - 1);
+    for (int cid=0; cid<numCls; ++cid)
+    {
+        for (int i=clsStart[cid]; i<clsStart[cid+1]; ++i)
+            occ[next[litIdx(lits[i])]++] = cid;
+    }
+
+    numTrue.assign(numCls, 0);
+    critVar.assign(numCls, 0);
+    unsatPos.assign(numCls, -1);
+    breakCnt.assign(maxVar+1, 0);
+    unsatList.clear();
+    unsatList.reserve(numCls);
+    score.assign(maxClsSize, 0);
+    if (!hasPhases)
+        assign.assign(maxVar+1, 0);
+    initProbs();
+    built = true;
+}
+
+
+/// @brief 預先計算 break 值對應的機率表
+void LocalSearch::initProbs()
+{
+    // probSAT 論文建議的參數：3-SAT 使用多項式形式，較長的子句使用指數形式
+    probs.assign(maxBreakTable + 1, 0);
+    for (int b=0; b<=maxBreakTable; ++b)
+    {
+        if (maxClsSize <= 3)
+            probs[b] = pow(1.0 + b, -2.38);
+        else
+        {
+            double cb = maxClsSize == 4 ? 3.0 : maxClsSize == 5 ? 3.7 :
+                        maxClsSize == 6 ? 5.1 : 5.4;
+            probs[b] = pow(cb, -b);
+        }
+    }
+}
+
+
+/// @brief 隨機產生賦值並重新計算搜尋狀態
+void LocalSearch::randomize()
+{
+    for (int v=1; v<=maxVar; ++v)
+        assign[v] = (char)(nextRand() >> 63);
+    recompute();
+}
+
+
+/// @brief 由目前的賦值重新計算每個子句的真文字數、關鍵變數與 break 值
+void LocalSearch::recompute()
+{
+    int numCls = (int)clsStart.size() - 1;
+    fill(breakCnt.begin(), breakCnt.end(), 0);
+    unsatList.clear();
+    for (int cid=0; cid<numCls; ++cid)
+    {
+        int cnt = 0, crit = 0;
+        for (int i=clsStart[cid]; i<clsStart[cid+1]; ++i)
+        {
+            int lit = lits[i];
+            if (assign[abs(lit)] == (lit > 0)) {
+                ++cnt;
+                crit ^= abs(lit);
+            }
+        }
+        numTrue[cid] = cnt;
+        critVar[cid] = crit;
+        unsatPos[cid] = -1;
+        if (cnt == 0)
+            addUnsat(cid);
+        else if (cnt == 1)
+            ++breakCnt[crit];
+    }
+}
+
+
+/// @brief 翻轉變數並以增量方式更新搜尋狀態
+/// @param vid 要翻轉的變數
+void LocalSearch::flip(int vid)
+{
+    assign[vid] ^= 1;
+    int trueLit = assign[vid] ? vid : -vid;
+
+    // 變為真的文字
+    int idx = litIdx(trueLit);
+    for (int k=occStart[idx]; k<occStart[idx+1]; ++k)
+    {
+        int cid = occ[k];
+        if (++numTrue[cid] == 1) {
+            removeUnsat(cid);
+            critVar[cid] = vid;
+            ++breakCnt[vid];
+        }
+        else {
+            if (numTrue[cid] == 2)
+                --breakCnt[critVar[cid]];
+            critVar[cid] ^= vid;
+        }
+    }
+
+    // 變為假的文字
+    idx = litIdx(-trueLit);
+    for (int k=occStart[idx]; k<occStart[idx+1]; ++k)
+    {
+        int cid = occ[k];
+        critVar[cid] ^= vid;
+        if (--numTrue[cid] == 0) {
+            addUnsat(cid);
+            --breakCnt[vid];
+        }
+        else if (numTrue[cid] == 1) {
+            ++breakCnt[critVar[cid]];
+        }
+    }
+    ++flips;
+}
+
+
+/// @brief 從隨機的不滿足子句中依 break 值的機率挑選要翻轉的變數
+/// @return 變數 ID
+int LocalSearch::pickVar()
+{
+    int cid = unsatList[nextRand() % unsatList.size()];
+    int begin = clsStart[cid], end = clsStart[cid+1];
+
+    // 只有 break 值以機率表大小為上限，子句中的每個文字都可能被選中
+    double sum = 0;
+    int n = end - begin;
+    for (int i=0; i<n; ++i)
+    {
+        score[i] = probs[min(breakCnt[abs(lits[begin+i])], maxBreakTable)];
+        sum += score[i];
+    }
+    double r = nextDouble() * sum;
+    for (int i=0; i<n-1; ++i)
+    {
+        r -= score[i];
+        if (r <= 0)
+            return abs(lits[begin+i]);
+    }
+    return abs(lits[begin+n-1]);
+}
+
+
+/// @brief 執行 probSAT，直到找到解、達到翻轉上限或超時
+/// @param maxFlips 翻轉上限（<=0 表示不限制）
+/// @param timeLimit 時間上限（秒，<=0 表示不限制）
+/// @return 是否找到滿足賦值
+bool LocalSearch::solve(long long maxFlips, double timeLimit)
+{
+    if (!built)
+        build();
+
+    // 空子句永遠無法被滿足
+    for (size_t cid=0; cid+1<clsStart.size(); ++cid)
+    {
+        if (clsStart[cid] == clsStart[cid+1])
+            return false;
+    }
+
+    auto startTime = chrono::steady_clock::now();
+    long long startFlips = flips;
+    bool found = false;
+
+    // 追蹤最佳賦值：記錄自 trailBase 之後翻轉的變數，避免每次改進都複製整個賦值
+    vector<char> trailBase;
+    vector<int> trail;
+    size_t bestPos = 0;
+    bool bestInTrail = false;
+    size_t trailLimit = max((size_t)maxVar, (size_t)1024);
+    auto settleBest = [&]() {
+        if (bestInTrail) {
+            bestAssign = trailBase;
+            for (size_t i=0; i<bestPos; ++i)
+                bestAssign[trail[i]] ^= 1;
+            bestInTrail = false;
+        }
+        trailBase = assign;
+        trail.clear();
+    };
+
+    bool stop = false;
+    while (!stop)
+    {
+        // 第一次嘗試使用給定的初始賦值，之後重新隨機產生
+        if (tries > 0 || !hasPhases)
+            randomize();
+        else
+            recompute();
+        ++tries;
+        settleBest();
+        if (bestUnsat == -1 || (int)unsatList.size() < bestUnsat) {
+            bestUnsat = (int)unsatList.size();
+            bestPos = 0;
+            bestInTrail = true;
+        }
+
+        long long tryEnd = flips + flipsPerTry;
+        while (!unsatList.empty())
+        {
+            if (flips >= tryEnd)
+                break;
+            if (maxFlips > 0 && flips - startFlips >= maxFlips) {
+                stop = true;
+                break;
+            }
+            if (timeLimit > 0 && (flips & 4095) == 0 &&
+                chrono::duration<double>(chrono::steady_clock::now() - startTime).count() > timeLimit) {
+                stop = true;
+                break;
+            }
+
+            int vid = pickVar();
+            flip(vid);
+            trail.push_back(vid);
+            if ((int)unsatList.size() < bestUnsat) {
+                bestUnsat = (int)unsatList.size();
+                bestPos = trail.size();
+                bestInTrail = true;
+            }
+            if (trail.size() >= trailLimit)
+                settleBest();
+        }
+        if (unsatList.empty()) {
+            found = true;
+            stop = true;
+        }
+    }
+    settleBest();
+
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    flipsPerSec = sec > 0 ? (flips - startFlips) / sec : 0;
+    return found;
+}
+
+
+/// @brief 以求解器的格式回傳最佳賦值
+/// @return ret[v] 為 v 或 -v；ret[0] 為 1 表示滿足，-1 表示未找到解
+vector<int> LocalSearch::result() const
+{
+    vector<int> ret(maxVar+1, bestUnsat == 0 ? 1 : -1);
+    for (int v=1; v<=maxVar; ++v)
+        ret[v] = (v < (int)bestAssign.size() && bestAssign[v]) ? v : -v;
+    return ret;
+}
@@ -0,0 +1,110 @@
+#ifndef __LOCALSEARCH_H
+#define __LOCALSEARCH_H
+
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+using namespace std;
+
+
+// 隨機局部搜尋 (probSAT)
+// 只依據 break 值挑選翻轉變數：P(v) ∝ f(break(v))，f 為預先計算的機率表。
+class LocalSearch
+{
+public:
+    void init(int maxVarIndex, uint64_t seed = 1);
+    void addClause(const vector<int> &cls);
+    void addClause(const int *lit, int n);
+    void setPhases(const vector<char> &phase);
+
+    bool solve(long long maxFlips, double timeLimit);
+    vector<int> result() const;
+
+    inline int size() const { return maxVar; }
+    inline int getUnsatCount() const { return (int)unsatList.size(); }
+    inline int getBestUnsatCount() const { return bestUnsat; }
+    inline const vector<char> &getBestAssign() const { return bestAssign; }
+
+    long long flips = 0;            // 翻轉次數
+    long long tries = 0;            // 重新開始次數
+    double    flipsPerSec = 0;      // 每秒翻轉次數
+
+    static const long long flipsPerTry = 2000000;  // 每次嘗試的翻轉上限
+    static constexpr int   maxBreakTable = 64;     // 機率表大小
+
+protected:
+    int maxVar = 0;
+    uint64_t rng = 1;
+
+    // 子句以 CSR 形式串接儲存
+    vector<int> lits;           // 所有子句的文字
+    vector<int> clsStart;       // 子句 c 的文字範圍 [clsStart[c], clsStart[c+1])
+    int maxClsSize = 0;
+
+    // 文字出現列表（以文字索引，CSR）
+    vector<int> occ;
+    vector<int> occStart;
+    bool built = false;
+
+    // 搜尋狀態
+    vector<char> assign;        // 變數的值
+    vector<int>  numTrue;       // 子句中為真的文字數
+    vector<int>  critVar;       // 為真文字變數的 xor，numTrue==1 時即為關鍵變數
+    vector<int>  breakCnt;      // 翻轉變數後會變成不滿足的子句數
+    vector<int>  unsatList;     // 不滿足的子句
+    vector<int>  unsatPos;      // 子句在 unsatList 中的位置（-1 表示已滿足）
+    vector<double> probs;       // break 值對應的機率
+    vector<double> score;       // pickVar 的暫存：子句中每個文字的機率（大小為最長子句）
+
+    vector<char> bestAssign;    // 不滿足子句數最少的賦值
+    int bestUnsat = -1;
+    bool hasPhases = false;
+
+    void build();
+    void initProbs();
+    void randomize();
+    void recompute();
+    void flip(int vid);
+    int  pickVar();
+
+    inline static int litIdx(int lit) { return (abs(lit)<<1) + (lit>0); }
+    inline uint64_t nextRand();
+    inline double nextDouble();
+    inline void addUnsat(int cid);
+    inline void removeUnsat(int cid);
+};
+
+
+/// @brief xorshift64* 亂數
+inline uint64_t LocalSearch::nextRand()
+{
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return rng * 0x2545F4914F6CDD1DULL;
+}
+
+/// @brief [0, 1) 之間的亂數
+inline double LocalSearch::nextDouble()
+{
+    return (nextRand() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/// @brief 將子句加入不滿足列表 (O(1))
+inline void LocalSearch::addUnsat(int cid)
+{
+    unsatPos[cid] = (int)unsatList.size();
+    unsatList.push_back(cid);
+}
+
+/// @brief 將子句移出不滿足列表 (O(1)，與最後一項交換)
+inline void LocalSearch::removeUnsat(int cid)
+{
+    int last = unsatList.back();
+    unsatList[unsatPos[cid]] = last;
+    unsatPos[last] = unsatPos[cid];
+    unsatList.pop_back();
+    unsatPos[cid] = -1;
+}
+
+#endif
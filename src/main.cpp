@@ -2,6 +2,7 @@
 #include <ctime>
 #include <cstring>
 #include <cstdlib>
+#include <csignal>
 #include <vector>
 #include <thread>
 #include <iostream>
@@ -9,11 +10,20 @@
 #include <mutex>
 #include <filesystem>
 #include "solver.h"
+#include "localsearch.h"
+#include "sampler.h"
+#include "server.h"
+#include "cache.h"
+#include "metrics.h"
+#include "perfcount.h"
+#include "trace.h"
+#include "tune.h"
 using namespace std;
 namespace fs = std::filesystem;
 
 
 int solveDone = 0;
+volatile sig_atomic_t stopRequested = 0;
 vector<int> result;
 
 vector<string> conditionNameList;
@@ -23,11 +33,624 @@ vector<string> classNameList;
 vector<vector<float>> classCondMeanList;
 
 
-int main(int argc, const char *argv[])
+// 命令列選項
+struct Options
+{
+    const char *cnfFile = nullptr;      // CNF 檔案
+    int         mode = 20;              // 執行模式 (BCP + VSIDS + JW)
+    int         timeout = 10;           // 超時時間（秒）
+    const char *proofFile = nullptr;    // DRAT 證明檔
+    bool        binaryProof = false;    // 是否輸出二進位 DRAT
+    bool        competition = false;    // 以 s/v 行格式輸出結果
+    const char *outputFile = nullptr;   // 結果輸出檔（預設為 stdout）
+    bool        verify = false;         // 以原始子句驗證模型
+    int         verifyThreads = 0;      // 驗證使用的執行緒數（0 表示自動）
+    bool        sls = false;            // 只使用局部搜尋 (probSAT)
+    bool        enumerate = false;      // 列舉所有解
+    long long   enumLimit = 0;          // 最多列舉的解數（0 表示不限）
+    bool        enumMinimize = false;   // 將解縮小成部分賦值
+    bool        core = false;           // 不可滿足時輸出 UNSAT core
+    bool        coreMinimize = false;   // 最小化 UNSAT core
+    bool        server = false;         // 批次求解伺服器模式
+    const char *socketPath = nullptr;   // 伺服器的 Unix domain socket（預設為 stdin/stdout）
+    int         workers = 0;            // 伺服器的工作執行緒數（0 表示自動）
+    const char *cacheDir = nullptr;     // 結果快取目錄
+    uint64_t    seed = 1;               // 亂數種子
+    bool        pin = false;            // 伺服器的工作執行緒綁定 CPU
+    bool        hugePages = false;      // 以透明大頁配置子句文字
+    bool        stats = false;          // 輸出搜尋統計（衝突數、傳播數）
+    const char *metricsFile = nullptr;  // 定期寫入 Prometheus 統計的檔案
+    int         metricsPort = 0;        // 以 HTTP 提供 Prometheus 統計的本機連接埠
+    int         metricsInterval = 1000; // 統計更新間隔（毫秒）
+    const char *traceFile = nullptr;    // Chrome trace JSON 輸出檔（需以 SAT_TRACE 建置）
+    bool        perf = false;           // 輸出各階段的硬體計數器
+    const char *checkpointFile = nullptr;  // 求解狀態快照檔
+    int         checkpointInterval = 0;    // 定期寫入快照的間隔（秒，0 表示只在停止時寫入）
+    const char *resumeFile = nullptr;      // 從此快照接續搜尋
+    SolverParams params;                // 求解參數（預設值加上設定檔與 --set）
+    const char *configFile = nullptr;   // 啟動時載入的參數設定檔
+    const char *className = nullptr;    // 設定檔中使用的類別（預設為 CNF 檔所在的目錄名稱）
+    vector<pair<string, string>> sets;  // --set 指定的參數，優先於設定檔
+    const char *tuneDir = nullptr;      // 自動調校的測資目錄
+    const char *tuneOut = "tuned.cfg";  // 自動調校輸出的設定檔
+    int         tuneConfigs = 16;       // 每個類別的候選設定數
+    long long   tuneBudget = 100000;    // 第一輪每個測資的傳播數上限
+};
+
+
+static void printUsage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options] <file.cnf>\n"
+        "       %s --server[=<socket>] [options]\n"
+        "       %s                      (run all benchmarks)\n"
+        "options:\n"
+        "  --mode=<n>        run mode bitmask (default 20)\n"
+        "  --timeout=<sec>   time limit in seconds (default 10)\n"
+        "  --proof=<file>    write a DRAT proof\n"
+        "  --binary-proof    write the proof in binary DRAT format\n"
+        "  --competition     print s/v lines in SAT competition format\n"
+        "                    (implies --verify)\n"
+        "  --output=<file>   write the s/v lines to a file instead of stdout\n"
+        "  --verify          check the model against the original clauses\n"
+        "  --verify-threads=<n>  threads used by --verify (default: all cores)\n"
+        "  --sls             solve with stochastic local search (probSAT) only\n"
+        "  --enum[=<n>]      enumerate up to n models (default: all), projected on\n"
+        "                    the \"c p show\" / \"c ind\" variables when present\n"
+        "  --enum-minimize   shrink each model to a partial assignment (cube)\n"
+        "  --core            print an UNSAT core (as CNF) when unsatisfiable\n"
+        "  --core-minimize   shrink the core until every clause is necessary\n"
+        "  --server[=<sock>] solve jobs read from stdin (or a Unix socket):\n"
+        "                    \"solve <id> <bytes> [timeout=<s>] [mode=<n>] [seed=<n>]\"\n"
+        "                    followed by the CNF text\n"
+        "  --workers=<n>     server worker threads (default: all cores)\n"
+        "  --pin             pin each server worker to its own CPU so that its solver\n"
+        "                    memory is allocated on the local NUMA node\n"
+        "  --huge-pages      back clause storage with transparent huge pages\n"
+        "  --metrics=<file>  write live Prometheus metrics to a file\n"
+        "  --metrics-port=<port>  serve live Prometheus metrics on 127.0.0.1:<port>\n"
+        "  --metrics-interval=<ms>  metrics update interval (default 1000)\n"
+        "  --trace=<file>    write a Chrome trace of the solver phases (needs a\n"
+        "                    build with -DSAT_TRACE=ON)\n"
+        "  --checkpoint=<file>  save the search state to <file> on timeout, on\n"
+        "                    SIGTERM/SIGINT and every --checkpoint-interval seconds\n"
+        "  --checkpoint-interval=<sec>  also save the search state periodically\n"
+        "  --resume=<file>   continue the search saved in <file> (same CNF file)\n"
+        "  --perf            print cycles, instructions, cache and branch misses per\n"
+        "                    solver phase (needs perf_event_open)\n"
+        "  --cache=<dir>     reuse results of formulas solved before (same clauses\n"
+        "                    in any order); results are stored in <dir>\n"
+        "  --config=<file>   load solver parameters from a config file written by --tune\n"
+        "  --class=<name>    config section to use (default: the CNF file's directory)\n"
+        "  --set=<name>=<value>  override one solver parameter\n"
+        "  --tune=<dir>      tune the parameters of --mode on each subdirectory of\n"
+        "                    <dir> and write the best one per class to --tune-out\n"
+        "  --tune-out=<file> config file written by --tune (default tuned.cfg)\n"
+        "  --tune-configs=<n>  candidate configurations per class (default 16)\n"
+        "  --tune-budget=<n>  propagations per instance in the first round, doubled\n"
+        "                    every round (default 100000)\n"
+        "  --seed=<n>        random seed; the same seed gives the same search (default 1)\n"
+        "  --stats           print conflicts, propagations and restarts\n",
+        prog, prog, prog);
+}
+
+
+static bool parseOptions(int argc, const char *argv[], Options &opt)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg.rfind("--mode=", 0) == 0)
+            opt.mode = atoi(arg.c_str() + 7);
+        else if (arg.rfind("--timeout=", 0) == 0)
+            opt.timeout = atoi(arg.c_str() + 10);
+        else if (arg.rfind("--proof=", 0) == 0)
+            opt.proofFile = argv[i] + 8;
+        else if (arg == "--binary-proof")
+            opt.binaryProof = true;
+        else if (arg == "--competition")
+            opt.competition = opt.verify = true;
+        else if (arg.rfind("--output=", 0) == 0)
+            opt.outputFile = argv[i] + 9;
+        else if (arg == "--verify")
+            opt.verify = true;
+        else if (arg.rfind("--verify-threads=", 0) == 0)
+            opt.verifyThreads = atoi(arg.c_str() + 17);
+        else if (arg == "--sls")
+            opt.sls = true;
+        else if (arg == "--enum")
+            opt.enumerate = true;
+        else if (arg.rfind("--enum=", 0) == 0)
+            opt.enumerate = true, opt.enumLimit = atoll(arg.c_str() + 7);
+        else if (arg == "--enum-minimize")
+            opt.enumerate = opt.enumMinimize = true;
+        else if (arg == "--core")
+            opt.core = true;
+        else if (arg == "--core-minimize")
+            opt.core = opt.coreMinimize = true;
+        else if (arg == "--server")
+            opt.server = true;
+        else if (arg.rfind("--server=", 0) == 0)
+            opt.server = true, opt.socketPath = argv[i] + 9;
+        else if (arg.rfind("--workers=", 0) == 0)
+            opt.workers = atoi(arg.c_str() + 10);
+        else if (arg.rfind("--cache=", 0) == 0)
+            opt.cacheDir = argv[i] + 8;
+        else if (arg.rfind("--seed=", 0) == 0)
+            opt.seed = strtoull(arg.c_str() + 7, nullptr, 10);
+        else if (arg == "--stats")
+            opt.stats = true;
+        else if (arg == "--pin")
+            opt.pin = true;
+        else if (arg == "--huge-pages")
+            opt.hugePages = true;
+        else if (arg.rfind("--metrics=", 0) == 0)
+            opt.metricsFile = argv[i] + 10;
+        else if (arg.rfind("--metrics-port=", 0) == 0)
+            opt.metricsPort = atoi(arg.c_str() + 15);
+        else if (arg.rfind("--metrics-interval=", 0) == 0)
+            opt.metricsInterval = atoi(arg.c_str() + 19);
+        else if (arg.rfind("--trace=", 0) == 0)
+            opt.traceFile = argv[i] + 8;
+        else if (arg == "--perf")
+            opt.perf = true;
+        else if (arg.rfind("--checkpoint=", 0) == 0)
+            opt.checkpointFile = argv[i] + 13;
+        else if (arg.rfind("--checkpoint-interval=", 0) == 0)
+            opt.checkpointInterval = atoi(arg.c_str() + 22);
+        else if (arg.rfind("--resume=", 0) == 0)
+            opt.resumeFile = argv[i] + 9;
+        else if (arg.rfind("--config=", 0) == 0)
+            opt.configFile = argv[i] + 9;
+        else if (arg.rfind("--class=", 0) == 0)
+            opt.className = argv[i] + 8;
+        else if (arg.rfind("--set=", 0) == 0)
+        {
+            size_t eq = arg.find('=', 6);
+            if (eq == string::npos)
+                return false;
+            opt.sets.emplace_back(arg.substr(6, eq - 6), arg.substr(eq + 1));
+        }
+        else if (arg.rfind("--tune=", 0) == 0)
+            opt.tuneDir = argv[i] + 7;
+        else if (arg.rfind("--tune-out=", 0) == 0)
+            opt.tuneOut = argv[i] + 11;
+        else if (arg.rfind("--tune-configs=", 0) == 0)
+            opt.tuneConfigs = atoi(arg.c_str() + 15);
+        else if (arg.rfind("--tune-budget=", 0) == 0)
+            opt.tuneBudget = atoll(arg.c_str() + 14);
+        else if (arg[0] != '-' && opt.cnfFile == nullptr)
+            opt.cnfFile = argv[i];
+        else
+            return false;
+    }
+    return opt.cnfFile != nullptr || opt.server || opt.tuneDir;
+}
+
+
+// 以 SAT 競賽格式輸出結果（s 行與 v 行）
+static void writeCompetitionOutput(FILE *out, const vector<int> &res, bool known)
+{
+    if (!known || res[0] == -1) {
+        fputs("s UNKNOWN\n", out);
+        return;
+    }
+    if (!res[0]) {
+        fputs("s UNSATISFIABLE\n", out);
+        return;
+    }
+    fputs("s SATISFIABLE\n", out);
+
+    // 每行不超過 80 個字元
+    string line = "v";
+    char tmp[16];
+    for (size_t i = 1; i < res.size(); ++i)
+    {
+        int len = snprintf(tmp, sizeof(tmp), " %d", res[i]);
+        if (line.size() + len > 80) {
+            line += '\n';
+            fwrite(line.data(), 1, line.size(), out);
+            line = "v";
+        }
+        line.append(tmp, len);
+    }
+    line += " 0\n";
+    fwrite(line.data(), 1, line.size(), out);
+}
+
+
+// 以結果的格式輸出（競賽格式或一般格式）
+static int reportResult(const Options &opt, const vector<int> &res, bool known, float totalTime)
+{
+    if (opt.competition)
+    {
+        FILE *out = stdout;
+        if (opt.outputFile && (out = fopen(opt.outputFile, "w")) == NULL) {
+            fprintf(stderr, "ERROR! Could not open output file: %s\n", opt.outputFile);
+            return 1;
+        }
+        fprintf(out, "c time %.3f ms\n", totalTime);
+        writeCompetitionOutput(out, res, known);
+        if (out != stdout)
+            fclose(out);
+        if (!known)
+            return 1;
+        // SAT 競賽的結束碼慣例
+        return res[0] == -1 ? 0 : (res[0] ? 10 : 20);
+    }
+
+    if (!known)
+        cout << "MODEL VERIFICATION FAILED" << endl;
+    else if (res[0] == -1)
+        cout << "TIMEOUT" << endl;
+    else if (res[0])
+        cout << "SATISFIABLE,   Time = " << totalTime << "ms" << endl;
+    else
+        cout << "UNSATISFIABLE, Time = " << totalTime << "ms" << endl;
+    return known ? 0 : 1;
+}
+
+
+// 依選項開始匯出統計，並讓求解器在搜尋時發布統計
+static bool startMetrics(const Options &opt, MetricsExporter &exporter, solver &yasat)
 {
-    srand((unsigned int)time(NULL));
+    if (!opt.metricsFile && opt.metricsPort <= 0)
+        return true;
+    exporter.metrics.phase = SolverMetrics::PARSE;
+    if (!exporter.start(opt.metricsFile, opt.metricsPort, opt.metricsInterval))
+        return false;
+    yasat.metrics = &exporter.metrics;
+    return true;
+}
+
+
+// 只以局部搜尋求解單一 CNF 檔（無法證明不可滿足）
+static int runLocalSearch(const Options &opt)
+{
+    auto startTime = std::chrono::high_resolution_clock::now();
+    vector<vector<int>> raw;
+    int maxVarIndex;
+    parse_DIMACS_CNF(raw, maxVarIndex, opt.cnfFile);
+
+    LocalSearch ls;
+    ls.init(maxVarIndex, opt.seed);
+    BitSampler sampler;
+    sampler.init(maxVarIndex, opt.seed ^ 0x9E3779B97F4A7C15ULL);
+    for (auto &cls : raw)
+    {
+        ls.addClause(cls);
+        sampler.addClause(cls);
+    }
+    // 以位元平行取樣的最佳賦值作為第一次嘗試的起點
+    vector<char> phase;
+    int sampleUnsat = sampler.sample(opt.params.sampleRounds, phase);
+    ls.setPhases(phase);
+    ls.solve(0, opt.timeout);
+    result = ls.result();
+
+    // 直接以原始子句驗證
+    bool known = true;
+    if (opt.verify && result[0] > 0)
+    {
+        for (auto &cls : raw)
+        {
+            bool satisfied = false;
+            for (int lit : cls)
+                satisfied |= (result[abs(lit)] == lit);
+            if (!satisfied) {
+                fprintf(stderr, "ERROR! Model falsifies an original clause\n");
+                known = false;
+                break;
+            }
+        }
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    float totalTime =
+        std::chrono::duration<float, std::milli> (endTime - startTime).count();
+    printf("c sampled %lld assignments (%s), best unsat %d\n",
+           sampler.evaluated, sampler.useAVX2 ? "avx2" : "scalar", sampleUnsat);
+    printf("c flips %lld, tries %lld, %.0f flips/sec, best unsat %d\n",
+           ls.flips, ls.tries, ls.flipsPerSec, ls.getBestUnsatCount());
+    return reportResult(opt, result, known, totalTime);
+}
+
+
+// 列舉單一 CNF 檔的所有解，每個解輸出一行 v 行
+static int runEnumerate(const Options &opt)
+{
+    if (opt.proofFile) {
+        fprintf(stderr, "ERROR! --proof cannot be used with --enum\n");
+        return 1;
+    }
+    FILE *out = stdout;
+    if (opt.outputFile && (out = fopen(opt.outputFile, "w")) == NULL) {
+        fprintf(stderr, "ERROR! Could not open output file: %s\n", opt.outputFile);
+        return 1;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    MetricsExporter exporter;
+    solver yasat;
+    if (!startMetrics(opt, exporter, yasat))
+        return 1;
+    yasat.seed = opt.seed;
+    yasat.params = opt.params;
+    yasat.hugePages = opt.hugePages;
+    yasat.init(opt.cnfFile, opt.mode);
+    yasat.timeout = opt.timeout;
+    vector<int> proj;
+    int declaredVars;
+    parse_DIMACS_projection(proj, declaredVars, opt.cnfFile);
+
+    string line;
+    long long models = yasat.enumerate(proj, declaredVars, opt.enumLimit, opt.enumMinimize,
+        [&](const vector<int> &cube) {
+            line = "v";
+            for (int lit : cube) {
+                line += ' ';
+                line += to_string(lit);
+            }
+            line += " 0\n";
+            fwrite(line.data(), 1, line.size(), out);
+            return true;
+        });
+    if (out != stdout)
+        fclose(out);
+    if (yasat.metrics)
+        yasat.publishMetrics(SolverMetrics::DONE);
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    float totalTime =
+        std::chrono::duration<float, std::milli> (endTime - startTime).count();
+    printf("c models %lld, projected count %.0Lf%s, %.0f models/sec\n",
+           models, yasat.projCount, yasat.enumComplete ? "" : " (incomplete)",
+           totalTime > 0 ? models * 1000.0 / totalTime : 0.0);
+    printf("c conflicts %lld, time %.3f ms\n", yasat.conflicts, totalTime);
+    return 0;
+}
 
 
+// 以原始子句驗證模型，錯誤的答案不得輸出
+static bool checkModel(const Options &opt, const solver &yasat, const vector<int> &res)
+{
+    if (!opt.verify || res[0] <= 0)
+        return true;
+    int threads = opt.verifyThreads > 0 ?
+        opt.verifyThreads : (int)max(1u, thread::hardware_concurrency());
+    long long bad = yasat.verifyModel(res, threads);
+    if (bad != -1) {
+        fprintf(stderr, "ERROR! Model falsifies original clause %lld\n", bad);
+        return false;
+    }
+    return true;
+}
+
+
+// 求解單一 CNF 檔，不可滿足時以 CNF 格式輸出 UNSAT core
+static int runCore(const Options &opt)
+{
+    if (opt.proofFile || opt.competition || opt.enumerate) {
+        fprintf(stderr, "ERROR! --core cannot be used with --proof, --competition or --enum\n");
+        return 1;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    MetricsExporter exporter;
+    solver yasat;
+    if (!startMetrics(opt, exporter, yasat))
+        return 1;
+    yasat.verify = opt.verify;
+    yasat.seed = opt.seed;
+    yasat.params = opt.params;
+    yasat.hugePages = opt.hugePages;
+    yasat.trackCore = true;
+    yasat.init(opt.cnfFile, opt.mode);
+    yasat.timeout = opt.timeout;
+    yasat.solveCore(opt.coreMinimize);
+    result = yasat.result();
+    if (yasat.metrics)
+        yasat.publishMetrics(SolverMetrics::DONE);
+    bool known = checkModel(opt, yasat, result);
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    float totalTime =
+        std::chrono::duration<float, std::milli> (endTime - startTime).count();
+    int ret = reportResult(opt, result, known, totalTime);
+    if (result[0] != 0)
+        return ret;
+
+    // 子句本身從 CNF 檔重新讀取；基數約束不在 core 中，一律輸出
+    vector<vector<int>> raw;
+    vector<CardConstraint> cards;
+    int maxVarIndex;
+    parse_DIMACS_CNF(raw, cards, maxVarIndex, opt.cnfFile);
+    const vector<int> &core = yasat.core();
+    printf("c core %zu of %zu clauses%s, %d solver calls\n", core.size(), raw.size(),
+           yasat.coreMinimal ? " (minimal)" : "", yasat.coreCalls);
+
+    FILE *out = stdout;
+    if (opt.outputFile && (out = fopen(opt.outputFile, "w")) == NULL) {
+        fprintf(stderr, "ERROR! Could not open output file: %s\n", opt.outputFile);
+        return 1;
+    }
+    fprintf(out, "p cnf %d %zu\n", maxVarIndex, core.size() + cards.size());
+    for (int i : core)
+    {
+        fprintf(out, "c clause %d\n", i + 1);
+        for (int lit : raw[i])
+            fprintf(out, "%d ", lit);
+        fputs("0\n", out);
+    }
+    for (auto &cd : cards)
+    {
+        for (int lit : cd.lit)
+            fprintf(out, "%d ", lit);
+        fprintf(out, "<= %d\n", cd.k);
+    }
+    if (out != stdout)
+        fclose(out);
+    return ret;
+}
+
+
+// 停止訊號：搜尋在下一個決策前寫入快照後結束
+static void onStopSignal(int)
+{
+    stopRequested = 1;
+}
+
+
+// 求解單一 CNF 檔
+static int runSingle(const Options &opt)
+{
+    if ((opt.checkpointFile || opt.resumeFile) && opt.proofFile) {
+        fprintf(stderr, "ERROR! --checkpoint and --resume cannot be used with --proof\n");
+        return 1;
+    }
+    // 續跑時以快照的執行模式與亂數種子初始化，預處理的結果才會相同
+    SolverSnapshot snap;
+    int mode = opt.mode;
+    uint64_t seed = opt.seed;
+    if (opt.resumeFile)
+    {
+        string err;
+        if (!snap.load(opt.resumeFile, err)) {
+            fprintf(stderr, "ERROR! Could not resume from %s: %s\n", opt.resumeFile, err.c_str());
+            return 1;
+        }
+        mode = snap.mode;
+        seed = snap.seed;
+    }
+
+    MetricsExporter exporter;
+    PerfCounters perf;
+    solver yasat;
+    if (opt.proofFile && !yasat.setProof(opt.proofFile, opt.binaryProof))
+        return 1;
+    if (!startMetrics(opt, exporter, yasat))
+        return 1;
+    // 無法使用計數器（例如沒有 PMU 的容器）時照常求解，只是不輸出報告
+    if (opt.perf) {
+        if (perf.open())
+            yasat.perf = &perf;
+        else
+            printf("c perf counters unavailable: %s\n", perf.error().c_str());
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    yasat.verify = opt.verify;
+    yasat.seed = seed;
+    yasat.params = opt.params;
+    yasat.hugePages = opt.hugePages;
+
+    // 使用快取時先解析並計算公式雜湊；需要證明時一律重新求解
+    ResultCache cache;
+    FormulaHash key;
+    bool useCache = opt.cacheDir && !opt.proofFile;
+    if (useCache && !cache.open(opt.cacheDir)) {
+        fprintf(stderr, "WARNING! Could not open cache directory: %s\n", opt.cacheDir);
+        useCache = false;
+    }
+    bool snapshots = opt.checkpointFile || opt.resumeFile;
+    uint64_t formulaHash = 0;
+    if (!useCache && !snapshots)
+        yasat.init(opt.cnfFile, mode);
+    else
+    {
+        vector<vector<int>> raw;
+        vector<CardConstraint> cards;
+        int maxVarIndex;
+        {
+            TRACE_SCOPE("parse");
+            PerfScope ps(yasat.perf, PerfCounters::PARSE);
+            parse_DIMACS_CNF(raw, cards, maxVarIndex, opt.cnfFile);
+        }
+        CacheEntry hit;
+        if (useCache)
+            key = hashFormula(raw, cards, maxVarIndex);
+        // SAT 的模型一律以原始子句檢查，雜湊碰撞或損壞的檔案不會造成錯誤的答案
+        if (useCache && cache.lookup(key, hit) && (hit.status == 0 ||
+            (hit.status == 1 && hit.satisfies(raw, cards))))
+        {
+            printf("c cache hit %s\n", key.hex().c_str());
+            exporter.metrics.phase = SolverMetrics::DONE;
+            result = hit.status == 1 ? hit.model : vector<int>{0};
+            auto endTime = std::chrono::high_resolution_clock::now();
+            float totalTime =
+                std::chrono::duration<float, std::milli> (endTime - startTime).count();
+            return reportResult(opt, result, true, totalTime);
+        }
+        if (hit.status == -1 && hit.tried > 0)
+            printf("c cache: unknown after %d s, best %d unsatisfied clauses\n", hit.tried, hit.bestUnsat);
+        if (snapshots)
+            formulaHash = snapshotFormulaHash(raw, cards, maxVarIndex);
+        if (opt.resumeFile && (snap.formula != formulaHash || snap.maxVar != maxVarIndex)) {
+            fprintf(stderr, "ERROR! %s was saved for a different formula\n", opt.resumeFile);
+            return 1;
+        }
+        yasat.init(raw, cards, maxVarIndex, mode);
+    }
+    yasat.timeout = opt.timeout;
+    if (opt.resumeFile) {
+        yasat.resumeFrom = &snap;
+        printf("c resuming after %lld s: conflicts %lld, learnt clauses %zu, level-0 assignments %zu\n",
+               snap.elapsed, snap.conflicts, snap.learntLbd.size(), snap.trail.size());
+    }
+    if (opt.checkpointFile) {
+        yasat.checkpointFile = opt.checkpointFile;
+        yasat.checkpointInterval = opt.checkpointInterval;
+        yasat.formulaHash = formulaHash;
+        signal(SIGTERM, onStopSignal);
+        signal(SIGINT, onStopSignal);
+    }
+    yasat.solve();
+    result = yasat.result();
+    // 證明檔寫入失敗時照常輸出結果，但以非零結束碼表示證明不可用
+    bool proofOk = yasat.closeProof();
+    if (yasat.metrics)
+        yasat.publishMetrics(SolverMetrics::DONE);
+    if (mode & solver::GAUSS)
+        printf("c xors %d, gauss propagations %lld, gauss conflicts %lld\n",
+               yasat.xorsFound, yasat.gaussProps, yasat.gaussConflicts);
+    if (mode & solver::CARD)
+        printf("c at-most-one detected %d (%lld binary clauses), card propagations %lld, card conflicts %lld\n",
+               yasat.cardsDetected, yasat.cardRemovedCls, yasat.cardProps, yasat.cardConflicts);
+    if (opt.stats)
+        printf("c seed %llu, conflicts %lld, propagations %lld, restarts %lld\n",
+               (unsigned long long)seed, yasat.conflicts, yasat.propagations, yasat.restarts);
+    if (yasat.perf)
+        perf.report(stdout, yasat.propagations, yasat.conflicts, yasat.decisions);
+    if (yasat.checkpoints > 0)
+        printf("c checkpoint %s written %d times, %lld s searched in total\n",
+               opt.checkpointFile, yasat.checkpoints, yasat.elapsedBefore + yasat.runTime);
+
+    bool known = checkModel(opt, yasat, result);
+    if (useCache && known)
+    {
+        CacheEntry entry;
+        entry.status = result[0] == -1 ? -1 : (result[0] ? 1 : 0);
+        if (entry.status == 1)
+            entry.model = result;
+        entry.tried = opt.timeout;
+        entry.bestUnsat = yasat.lsBestUnsat;
+        if (!cache.store(key, entry))
+            fprintf(stderr, "WARNING! Could not write cache entry %s\n", key.hex().c_str());
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    float totalTime =
+        std::chrono::duration<float, std::milli> (endTime - startTime).count();
+
+    int ret = reportResult(opt, result, known, totalTime);
+    return proofOk ? ret : 1;
+}
+
+
+// 對 benchmark 目錄中的所有測資執行所有測試條件
+static int runBenchmarks()
+{
+
     /* 
         VSIDS         = 4
         MOM           = 8
@@ -117,3 +740,93 @@ int main(int argc, const char *argv[])
 
     return 0;
 }
+
+
+// 載入設定檔並套用 --set；設定檔的類別預設為 CNF 檔所在的目錄名稱
+static bool loadParams(Options &opt)
+{
+    if (opt.configFile)
+    {
+        string className = opt.className ? opt.className
+                         : opt.cnfFile ? fs::path(opt.cnfFile).parent_path().filename().string() : "";
+        string err;
+        if (!loadConfig(opt.configFile, className, opt.params, err)) {
+            fprintf(stderr, "ERROR! Could not load config %s: %s\n", opt.configFile, err.c_str());
+            return false;
+        }
+    }
+    for (auto &kv : opt.sets)
+        if (!setParam(opt.params, kv.first, kv.second)) {
+            fprintf(stderr, "ERROR! Invalid parameter setting: %s=%s\n", kv.first.c_str(), kv.second.c_str());
+            return false;
+        }
+    return true;
+}
+
+
+// 依選項執行對應的模式
+static int run(const Options &opt)
+{
+    if (opt.server)
+    {
+        ServerConfig cfg;
+        cfg.socketPath = opt.socketPath;
+        cfg.workers = opt.workers;
+        cfg.mode = opt.mode;
+        cfg.timeout = opt.timeout;
+        cfg.seed = opt.seed;
+        cfg.pin = opt.pin;
+        cfg.hugePages = opt.hugePages;
+        cfg.params = opt.params;
+        return runServer(cfg);
+    }
+    if (opt.tuneDir)
+    {
+        TuneConfig cfg;
+        cfg.dir = opt.tuneDir;
+        cfg.out = opt.tuneOut;
+        cfg.mode = opt.mode;
+        cfg.seed = opt.seed;
+        cfg.configs = opt.tuneConfigs;
+        cfg.budget = opt.tuneBudget;
+        cfg.workers = opt.workers;
+        cfg.base = opt.params;
+        return runTune(cfg);
+    }
+    if (opt.sls)
+        return runLocalSearch(opt);
+    if (opt.core)
+        return runCore(opt);
+    if (opt.enumerate)
+        return runEnumerate(opt);
+    return runSingle(opt);
+}
+
+
+int main(int argc, const char *argv[])
+{
+    if (argc == 1)
+        return runBenchmarks();
+
+    Options opt;
+    if (!parseOptions(argc, argv, opt))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (!loadParams(opt))
+        return 1;
+    if (!opt.traceFile)
+        return run(opt);
+
+#ifdef SAT_TRACE
+    traceStart();
+    int ret = run(opt);
+    if (!traceDump(opt.traceFile))
+        return 1;
+    return ret;
+#else
+    fprintf(stderr, "ERROR! --trace needs a build with -DSAT_TRACE=ON\n");
+    return 1;
+#endif
+}
@@ -0,0 +1,223 @@
+#include "metrics.h"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <algorithm>
+#ifdef __linux__
+#include <unistd.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+
+static const char *phaseName[] = {"idle", "parse", "preprocess", "search", "done"};
+
+
+/// @brief 開始匯出
+/// @param path Prometheus 文字檔的路徑（nullptr 表示不寫檔）
+/// @param listenPort 在 127.0.0.1 上以 HTTP 提供的連接埠（0 表示不提供）
+/// @param interval 更新間隔（毫秒）
+/// @return 是否成功
+bool MetricsExporter::start(const char *path, int listenPort, int interval)
+{
+    file = path ? path : "";
+    port = listenPort;
+    intervalMs = max(interval, 10);
+    if (port > 0)
+    {
+#ifdef __linux__
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (listenFd < 0 ||
+            setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) < 0 ||
+            bind(listenFd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(listenFd, 16) < 0)
+        {
+            fprintf(stderr, "ERROR! Could not listen on metrics port %d (%s)\n", port, strerror(errno));
+            if (listenFd >= 0)
+                close(listenFd);
+            listenFd = -1;
+            return false;
+        }
+#else
+        fprintf(stderr, "ERROR! Serving metrics over HTTP is not supported on this platform\n");
+        return false;
+#endif
+    }
+    running = true;
+    th = thread(&MetricsExporter::run, this);
+    return true;
+}
+
+
+/// @brief 停止匯出；結束前會再輸出一次最終的統計
+void MetricsExporter::stop()
+{
+    if (!running.exchange(false))
+        return;
+    th.join();
+#ifdef __linux__
+    if (listenFd >= 0)
+        close(listenFd);
+    listenFd = -1;
+#endif
+}
+
+
+// 行程的常駐記憶體大小（位元組）
+static long long residentBytes()
+{
+#ifdef __linux__
+    long long pages = 0, rss = 0;
+    FILE *in = fopen("/proc/self/statm", "r");
+    if (in == NULL)
+        return 0;
+    if (fscanf(in, "%lld %lld", &pages, &rss) != 2)
+        rss = 0;
+    fclose(in);
+    return rss * sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+
+/// @brief 產生 Prometheus 文字格式
+/// @param conflictRate 最近一個間隔的每秒衝突數
+/// @param propagationRate 最近一個間隔的每秒傳播數
+string MetricsExporter::render(double conflictRate, double propagationRate) const
+{
+    string out;
+    char buf[256];
+    auto metric = [&](const char *name, const char *type, const char *help, double value) {
+        snprintf(buf, sizeof(buf), "# HELP %s %s\n# TYPE %s %s\n%s %.17g\n",
+                 name, help, name, type, name, value);
+        out += buf;
+    };
+    const SolverMetrics &m = metrics;
+    metric("sat_conflicts_total", "counter", "Conflicts found.", (double)m.conflicts.load(memory_order_relaxed));
+    metric("sat_propagations_total", "counter", "Literals assigned.", (double)m.propagations.load(memory_order_relaxed));
+    metric("sat_decisions_total", "counter", "Decisions made.", (double)m.decisions.load(memory_order_relaxed));
+    metric("sat_restarts_total", "counter", "Restarts.", (double)m.restarts.load(memory_order_relaxed));
+    metric("sat_conflicts_per_second", "gauge", "Conflicts per second over the last interval.", conflictRate);
+    metric("sat_propagations_per_second", "gauge", "Propagations per second over the last interval.", propagationRate);
+    metric("sat_learnt_clauses", "gauge", "Learnt clauses in the database.", (double)m.learnts.load(memory_order_relaxed));
+    metric("sat_clauses", "gauge", "Clauses in the database.", (double)m.clauses.load(memory_order_relaxed));
+    metric("sat_trail_depth", "gauge", "Assigned variables.", (double)m.trail.load(memory_order_relaxed));
+    metric("sat_decision_level", "gauge", "Current decision level.", (double)m.level.load(memory_order_relaxed));
+    metric("sat_resident_memory_bytes", "gauge", "Resident set size of the process.", (double)residentBytes());
+
+    out += "# HELP sat_phase Current solver phase.\n# TYPE sat_phase gauge\n";
+    int phase = m.phase.load(memory_order_relaxed);
+    for (int p = SolverMetrics::IDLE; p <= SolverMetrics::DONE; ++p)
+    {
+        snprintf(buf, sizeof(buf), "sat_phase{phase=\"%s\"} %d\n", phaseName[p], p == phase);
+        out += buf;
+    }
+    return out;
+}
+
+
+/// @brief 寫到暫存檔再改名取代，讀取者不會看到寫到一半的檔案
+void MetricsExporter::writeFile(const string &text) const
+{
+    string tmp = file + ".tmp";
+    FILE *out = fopen(tmp.c_str(), "w");
+    if (out == NULL)
+        return;
+    bool ok = fwrite(text.data(), 1, text.size(), out) == text.size();
+    ok &= fclose(out) == 0;
+    if (ok)
+        rename(tmp.c_str(), file.c_str());
+}
+
+
+/// @brief 接受一個 HTTP 連線並回應目前的統計（不論請求的路徑）
+void MetricsExporter::serveOne(const string &text) const
+{
+#ifdef __linux__
+    int fd = accept(listenFd, nullptr, nullptr);
+    if (fd < 0)
+        return;
+    char req[4096];
+    pollfd pfd = {fd, POLLIN, 0};
+    if (poll(&pfd, 1, 100) > 0 && recv(fd, req, sizeof(req), 0) >= 0)
+    {
+        string resp = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                      "Content-Length: " + to_string(text.size()) + "\r\n\r\n" + text;
+        size_t done = 0;
+        while (done < resp.size())
+        {
+            long n = (long)send(fd, resp.data() + done, resp.size() - done, MSG_NOSIGNAL);
+            if (n <= 0)
+                break;
+            done += (size_t)n;
+        }
+    }
+    close(fd);
+#else
+    (void)text;
+#endif
+}
+
+
+/// @brief 匯出執行緒：每個間隔計算速率並更新輸出，間隔之間回應 HTTP 請求
+void MetricsExporter::run()
+{
+#ifdef __linux__
+    // 只使用閒置的 CPU 時間，不與求解執行緒競爭
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 19);
+#endif
+    using clk = chrono::steady_clock;
+    auto last = clk::now();
+    long long lastConflicts = 0, lastProps = 0;
+    double conflictRate = 0, propagationRate = 0;
+    string text;
+
+    while (true)
+    {
+        bool stopping = !running.load();
+        auto now = clk::now();
+        double sec = chrono::duration<double>(now - last).count();
+        long long c = metrics.conflicts.load(memory_order_relaxed);
+        long long p = metrics.propagations.load(memory_order_relaxed);
+        if (sec > 0) {
+            conflictRate = (c - lastConflicts) / sec;
+            propagationRate = (p - lastProps) / sec;
+        }
+        last = now;
+        lastConflicts = c;
+        lastProps = p;
+
+        text = render(conflictRate, propagationRate);
+        if (!file.empty())
+            writeFile(text);
+        if (stopping)
+            break;
+
+        // 等到下一個間隔；每 50 毫秒檢查一次是否停止
+        auto next = now + chrono::milliseconds(intervalMs);
+        while (running.load() && clk::now() < next)
+        {
+            int wait = (int)min<long long>(50, chrono::duration_cast<chrono::milliseconds>(next - clk::now()).count() + 1);
+#ifdef __linux__
+            if (listenFd >= 0) {
+                pollfd pfd = {listenFd, POLLIN, 0};
+                if (poll(&pfd, 1, wait) > 0)
+                    serveOne(text);
+                continue;
+            }
+#endif
+            this_thread::sleep_for(chrono::milliseconds(wait));
+        }
+    }
+}
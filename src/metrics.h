@@ -0,0 +1,54 @@
+#ifndef __METRICS_H
+#define __METRICS_H
+
+#include <atomic>
+#include <thread>
+#include <string>
+using namespace std;
+
+
+// 求解器定期發布的統計資訊。求解器只在搜尋迴圈中每隔一段決策以 relaxed 寫入，
+// 匯出執行緒只讀取，傳播與衝突分析中沒有任何同步。
+struct SolverMetrics
+{
+    enum Phase { IDLE, PARSE, PREPROCESS, SEARCH, DONE };
+
+    atomic<int>       phase{IDLE};
+    atomic<long long> conflicts{0};
+    atomic<long long> propagations{0};
+    atomic<long long> decisions{0};
+    atomic<long long> restarts{0};
+    atomic<long long> learnts{0};       // 學習子句數
+    atomic<long long> clauses{0};       // 子句總數
+    atomic<long long> trail{0};         // 已賦值的變數數
+    atomic<long long> level{0};         // 目前的決策層級
+};
+
+
+// 以 Prometheus 文字格式匯出 SolverMetrics：定期以改名取代的方式寫入檔案，
+// 或在本機的連接埠上以 HTTP 提供。匯出在低優先級的背景執行緒中進行。
+class MetricsExporter
+{
+public:
+    SolverMetrics metrics;
+
+    ~MetricsExporter() { stop(); }
+    bool start(const char *file, int port, int intervalMs);
+    void stop();
+
+protected:
+    string file;
+    int port = 0;
+    int intervalMs = 1000;
+    int listenFd = -1;
+    atomic<bool> running{false};
+    thread th;
+
+    void run();
+    string render(double conflictRate, double propagationRate) const;
+    void writeFile(const string &text) const;
+    void serveOne(const string &text) const;
+};
+
+
+#endif
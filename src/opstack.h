@@ -2,55 +2,59 @@
 #define __OPSTACK_H
 
 #include <vector>
+#include "literal.h"
 using namespace std;
 
 
+// 賦值狀態以 structure-of-arrays 儲存：
+// 文字的值以文字索引，層級與來源子句以變數索引，軌跡只記錄被設為真的文字。
 class opStack {
 
 public:
 
-    struct op {
-        int var, val, lv, src;
-    };
-    vector<op> stk;
+    vector<Lit> trail;              // 賦值軌跡
+    vector<signed char> value;      // 每個文字的值（0：假，1：真，2：未賦值）
+    vector<int> lvArr;              // 每個變數的決策層級（僅在已賦值時有效）
+    vector<int> srcArr;             // 每個變數的來源子句（僅在已賦值時有效）
 
     opStack() {}
-    opStack(int n) :stk(n), idx(n), level(n) {
+    opStack(int n) :trail(n), value(n << 1, 2), lvArr(n, -1), srcArr(n, -1), level(n) {
         level[0] = -1;
     }
-    
-    inline bool notSet(int id) const {
-        return idx[id] > _top || stk[idx[id]].var != id;
-    }
+
     inline int getVal(int id) const {
-        return notSet(id) ? 2 : stk[idx[id]].val;
+        return value[(id << 1) | 1];
+    }
+    inline int litVal(Lit lit) const {
+        return value[lit];
     }
     inline int getLv(int id) const {
-        return notSet(id) ? -1 : stk[idx[id]].lv;
+        return lvArr[id];
     }
     inline int getSrc(int id) const {
-        return notSet(id) ? -1 : stk[idx[id]].src;
+        return srcArr[id];
     }
-    inline op& topNext() {
-        // Return variable on decision or empty slot
-        return stk[_top+1];
+    inline Lit at(int i) const {
+        return trail[i];
     }
-    inline void set(int id, int val, int lv, int src) {
-        // Set id = val@lv
+    inline void set(Lit lit, int lv, int src) {
+        // Set lit = true @lv
+        int id = litVar(lit);
         ++_top;
-        stk[_top].var = id;
-        stk[_top].val = val;
-        stk[_top].lv = lv;
-        stk[_top].src = src;
-        idx[id] = _top;
+        trail[_top] = lit;
+        value[lit] = 1;
+        value[litNeg(lit)] = 0;
+        lvArr[id] = lv;
+        srcArr[id] = src;
         level[lv] = _top;
     }
     inline void backToLevel(int lv) {
-        // Move top pointer to that level's last assignment
+        // Unassign everything above that level's last assignment
+        for (int i = _top; i > level[lv]; --i)
+            value[trail[i]] = value[litNeg(trail[i])] = 2;
         _top = level[lv];
     }
 
-    vector<int> idx;
     vector<int> level;
     int _top = -1;
 
@@ -0,0 +1,158 @@
+#include "params.h"
+#include "solver.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+
+// 調校範圍只涵蓋以傳播數衡量工作量的參數；局部搜尋的翻轉與取樣的成本不計入
+// 傳播數，相關參數固定不調
+const ParamInfo paramTable[] = {
+    {"decay", &SolverParams::decay, nullptr, solver::VSIDS, 0.75, 0.99, false},
+    {"clause-size-threshold", nullptr, &SolverParams::clauseSzThreshold, solver::MOM, 3, 30, false},
+    {"restart-unit", nullptr, &SolverParams::restartUnit, solver::RESTART, 20, 1000, true},
+    {"vivify-interval", nullptr, &SolverParams::vivifyInterval, solver::VIVIFY, 500, 20000, true},
+    {"vivify-lbd-limit", nullptr, &SolverParams::vivifyLbdLimit, solver::VIVIFY, 2, 16, false},
+    {"vivify-effort", nullptr, &SolverParams::vivifyEffort, solver::VIVIFY, 1, 50, true},
+    {"rephase-interval", nullptr, &SolverParams::rephaseInterval, solver::RPHASE, 0, 0, false},
+    {"rephase-flips", nullptr, &SolverParams::rephaseFlips, solver::RPHASE, 0, 0, false},
+    {"sample-rounds", nullptr, &SolverParams::sampleRounds, solver::SAMPLE, 0, 0, false},
+};
+const int paramCount = (int)(sizeof(paramTable) / sizeof(paramTable[0]));
+
+
+const ParamInfo *findParam(const string &name)
+{
+    for (int i = 0; i < paramCount; ++i)
+        if (name == paramTable[i].name)
+            return &paramTable[i];
+    return nullptr;
+}
+
+
+/// @brief 以名稱設定參數；實數參數必須在 (0,1) 之間，整數參數必須為正
+/// @return 名稱不存在或數值不合法時回傳 false，參數不變
+bool setParam(SolverParams &p, const string &name, const string &value)
+{
+    const ParamInfo *info = findParam(name);
+    if (info == nullptr || value.empty())
+        return false;
+    char *end;
+    if (info->real)
+    {
+        double v = strtod(value.c_str(), &end);
+        if (*end != '\0' || !(v > 0 && v < 1))
+            return false;
+        p.*info->real = v;
+    }
+    else
+    {
+        long v = strtol(value.c_str(), &end, 10);
+        if (*end != '\0' || v <= 0 || v > 1000000000L)
+            return false;
+        p.*info->integer = (int)v;
+    }
+    return true;
+}
+
+
+string paramValue(const SolverParams &p, const ParamInfo &info)
+{
+    char buf[32];
+    if (info.real)
+        snprintf(buf, sizeof(buf), "%.6g", p.*info.real);
+    else
+        snprintf(buf, sizeof(buf), "%d", p.*info.integer);
+    return buf;
+}
+
+
+static string trim(const string &s)
+{
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == string::npos)
+        return "";
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+
+/// @brief 載入設定檔中適用於 className 的參數
+/// @param filename 設定檔
+/// @param className 類別名稱（通常是 CNF 檔所在的目錄名稱）
+/// @param p 要修改的參數
+/// @param err 失敗的原因
+/// @return 是否成功
+bool loadConfig(const char *filename, const string &className, SolverParams &p, string &err)
+{
+    FILE *in = fopen(filename, "r");
+    if (in == NULL) {
+        err = "could not open file";
+        return false;
+    }
+    // 所有區段的設定都先檢查，記錄所在的區段，之後分兩次套用
+    struct Setting { string section, name, value; };
+    vector<Setting> settings;
+    string section;
+    char buf[1024];
+    SolverParams check;
+    for (int lineNo = 1; fgets(buf, sizeof(buf), in); ++lineNo)
+    {
+        string line = trim(buf);
+        if (line.empty() || line[0] == '#')
+            continue;
+        if (line[0] == '[' && line.back() == ']')
+        {
+            section = trim(line.substr(1, line.size() - 2));
+            continue;
+        }
+        size_t eq = line.find('=');
+        Setting st{section, trim(line.substr(0, eq)), eq == string::npos ? "" : trim(line.substr(eq + 1))};
+        if (!setParam(check, st.name, st.value)) {
+            fclose(in);
+            err = "line " + to_string(lineNo) + ": invalid setting '" + line + "'";
+            return false;
+        }
+        settings.push_back(st);
+    }
+    fclose(in);
+
+    for (int pass = 0; pass < 2; ++pass)
+        for (auto &st : settings)
+        {
+            bool global = st.section.empty() || st.section == "default";
+            if (pass == 0 ? global : (!global && st.section == className))
+                setParam(p, st.name, st.value);
+        }
+    return true;
+}
+
+
+/// @brief 寫出每個類別的完整參數
+/// @param filename 設定檔
+/// @param comment 檔案開頭的註解（可含多行）
+/// @param classes 類別名稱與參數
+/// @return 是否成功
+bool writeConfig(const char *filename, const string &comment,
+                 const vector<pair<string, SolverParams>> &classes)
+{
+    FILE *out = fopen(filename, "w");
+    if (out == NULL)
+        return false;
+    size_t pos = 0;
+    while (pos < comment.size())
+    {
+        size_t nl = comment.find('\n', pos);
+        if (nl == string::npos)
+            nl = comment.size();
+        fprintf(out, "# %s\n", comment.substr(pos, nl - pos).c_str());
+        pos = nl + 1;
+    }
+    for (auto &cls : classes)
+    {
+        fprintf(out, "\n[%s]\n", cls.first.c_str());
+        for (int i = 0; i < paramCount; ++i)
+            fprintf(out, "%s = %s\n", paramTable[i].name, paramValue(cls.second, paramTable[i]).c_str());
+    }
+    return fclose(out) == 0;
+}
@@ -0,0 +1,50 @@
+#ifndef __PARAMS_H
+#define __PARAMS_H
+
+#include <string>
+#include <vector>
+#include <utility>
+using namespace std;
+
+
+// 可在執行時設定的求解參數，預設值即原本寫死的常數。
+// 每個參數以名稱列在 paramTable 中，設定檔、--set 與自動調校都經由這張表存取。
+struct SolverParams
+{
+    double decay = 0.9;             // VSIDS 優先級的衰減係數
+    int clauseSzThreshold = 10;     // MOM 只計入不超過此大小的子句
+    int restartUnit = 100;          // Luby 重新啟動的單位衝突數
+    int vivifyInterval = 2000;      // vivification 的衝突間隔
+    int vivifyLbdLimit = 8;         // vivification 候選子句的 LBD 上限
+    int vivifyEffort = 10;          // vivification 傳播預算（搜尋傳播數的百分比）
+    int rephaseInterval = 5000;     // 與局部搜尋交換相位的衝突間隔（逐次遞增）
+    int rephaseFlips = 300000;      // 每次局部搜尋的翻轉預算
+    int sampleRounds = 16;          // 初始相位取樣的輪數（每輪 256 組賦值）
+};
+
+
+// 參數的名稱、欄位與調校範圍
+struct ParamInfo
+{
+    const char *name;
+    double SolverParams::*real;     // 實數參數（整數參數為 nullptr）
+    int SolverParams::*integer;     // 整數參數（實數參數為 nullptr）
+    int modeMask;                   // 只在這些執行模式位元之一開啟時有作用
+    double lo, hi;                  // 調校範圍；lo == hi 表示不參與調校
+    bool logScale;                  // 以對數尺度取樣
+};
+
+extern const ParamInfo paramTable[];
+extern const int paramCount;
+
+const ParamInfo *findParam(const string &name);
+bool setParam(SolverParams &p, const string &name, const string &value);
+string paramValue(const SolverParams &p, const ParamInfo &info);
+
+// 設定檔：# 開頭為註解，[class] 開始一個類別的區段，其餘每行為 name = value。
+// 載入時先套用區段之外與 [default] 中的設定，再套用與 className 同名的區段。
+bool loadConfig(const char *filename, const string &className, SolverParams &p, string &err);
+bool writeConfig(const char *filename, const string &comment,
+                 const vector<pair<string, SolverParams>> &classes);
+
+#endif
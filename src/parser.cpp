@@ -7,33 +7,51 @@ CNF Parsing code
 #include "parser.h"
 #include <iostream>
 using std::ifstream;
+using std::string;
 #include <cstdlib>
 #include <cstdio>
 
 #define CHUNK_LIMIT 1048576
 
+// Reads either a file (in chunks) or text already in memory.  Parse
+// errors in a file are fatal; in memory they are recorded in `error'
+// and the rest of the input is skipped.
 class StreamBuffer {
 
-    FILE   *in;
-    char    buf[CHUNK_LIMIT];
-    int     pos;
-    int     size;
+    FILE         *in;
+    vector<char>  chunk;
+    const char   *buf;
+    size_t        pos;
+    size_t        size;
 
     void assureLookahead() {
-        if (pos >= size) {
+        if (in && pos >= size) {
             pos  = 0;
-            size = fread(buf, 1, sizeof(buf), in); 
+            size = fread(chunk.data(), 1, chunk.size(), in);
         } 
     }
 
 public:
-    StreamBuffer(FILE *i) : in(i), pos(0), size(0) {
+    string error;
+
+    StreamBuffer(FILE *i) : in(i), chunk(CHUNK_LIMIT), buf(chunk.data()), pos(0), size(0) {
         assureLookahead(); 
     }
+    StreamBuffer(const char *text, size_t len) : in(NULL), buf(text), pos(0), size(len) {}
 
     int  operator *  () { return (pos >= size) ? EOF : buf[pos]; }
     void operator ++ () { pos++; assureLookahead(); }
 
+    void fail(const char *msg, int c) {
+        char tmp[64];
+        snprintf(tmp, sizeof(tmp), "%s: %c", msg, c);
+        if (in)
+            fprintf(stderr, "PARSE ERROR! %s\n", tmp), exit(3);
+        if (error.empty())
+            error = tmp;
+        pos = size;
+    }
+
 };
 
 void skipWhitespace(StreamBuffer &in) {
@@ -56,8 +74,10 @@ int parseInt(StreamBuffer &in) {
     skipWhitespace(in);
     if      (*in == '-') neg = true, ++in;
     else if (*in == '+') ++in;
-    if (*in < '0' || *in > '9')
-        fprintf(stderr, "PARSE ERROR! Unexpected char: %c\n", *in), exit(3);
+    if (*in < '0' || *in > '9') {
+        in.fail("Unexpected char", *in);
+        return 0;
+    }
     while (*in >= '0' && *in <= '9') {
         val = val*10 + (*in - '0');
         ++in;
@@ -66,10 +86,41 @@ int parseInt(StreamBuffer &in) {
 }
 
 
-void readClause(StreamBuffer &in, vector<vector<int> > &clauses) {
+void readCard(StreamBuffer &in, vector<int> &lits, vector<CardConstraint> &cards) {
+    // Comparison operator: <=, >= or =
+    char op = *in;
+    ++in;
+    if (op != '=') {
+        if (*in != '=') {
+            in.fail("Unexpected char", *in);
+            return;
+        }
+        ++in;
+    }
+    int k = parseInt(in);
+    int n = (int)lits.size();
+
+    if (op == '<' || op == '=')
+        cards.push_back({lits, k});
+    if (op == '>' || op == '=') {
+        // At least k true <=> at most n-k false
+        vector<int> neg(lits);
+        for (auto &l : neg)
+            l = -l;
+        cards.push_back({neg, n - k});
+    }
+}
+
+
+void readClause(StreamBuffer &in, vector<vector<int> > &clauses, vector<CardConstraint> &cards) {
     int parsed_lit;
     vector<int> newClause;
     while (true) {
+        skipWhitespace(in);
+        if (*in == '<' || *in == '>' || *in == '=') {
+            readCard(in, newClause, cards);
+            return;
+        }
         parsed_lit = parseInt(in);
         if (parsed_lit == 0) break;
         newClause.push_back(parsed_lit);
@@ -78,41 +129,146 @@ void readClause(StreamBuffer &in, vector<vector<int> > &clauses) {
 }
 
 
-void parse_DIMACS_main(StreamBuffer &in, vector<vector<int> > &clauses) {
+void parse_DIMACS_main(StreamBuffer &in, vector<vector<int> > &clauses, vector<CardConstraint> &cards) {
     while (true) {
         skipWhitespace(in);
         if (*in == EOF) break;
         else if (*in == 'c' || *in == 'p') skipLine(in);
-        else readClause(in, clauses);
+        else readClause(in, clauses, cards);
     }
 }
 
 
-void parse_DIMACS(FILE *input_stream, vector<vector<int> > &clauses) {
+void parse_DIMACS(FILE *input_stream, vector<vector<int> > &clauses, vector<CardConstraint> &cards) {
     StreamBuffer in(input_stream);
-    parse_DIMACS_main(in, clauses);
+    parse_DIMACS_main(in, clauses, cards);
+}
+
+
+static void computeMaxVar(const vector<vector<int> > &clauses,
+        const vector<CardConstraint> &cards,
+        int &maxVarIndex) {
+    unsigned int i, j;
+    int candidate;
+    maxVarIndex = 0;
+    for (i = 0; i < clauses.size(); ++i)
+        for (j = 0; j < clauses[i].size(); ++j) {
+            candidate = abs(clauses[i][j]);
+            if (candidate > maxVarIndex) maxVarIndex = candidate;
+        }
+    for (i = 0; i < cards.size(); ++i)
+        for (j = 0; j < cards[i].lit.size(); ++j) {
+            candidate = abs(cards[i].lit[j]);
+            if (candidate > maxVarIndex) maxVarIndex = candidate;
+        }
 }
 
 
 void parse_DIMACS_CNF(vector<vector<int> > &clauses,
+        vector<CardConstraint> &cards,
         int &maxVarIndex,
         const char *DIMACS_cnf_file) {
-    unsigned int i, j;
-    int candidate;
     FILE *in = fopen(DIMACS_cnf_file, "r");
     if (in == NULL) {
         fprintf(stderr, "ERROR! Could not open file: %s\n",
         DIMACS_cnf_file);
         exit(1);
     }
-    parse_DIMACS(in, clauses);
+    parse_DIMACS(in, clauses, cards);
     fclose(in);
+    computeMaxVar(clauses, cards, maxVarIndex);
+}
 
-    maxVarIndex = 0;
-    for (i = 0; i < clauses.size(); ++i)
-        for (j = 0; j < clauses[i].size(); ++j) {
-            candidate = abs(clauses[i][j]);
-            if (candidate > maxVarIndex) maxVarIndex = candidate;
+
+bool parse_DIMACS_text(vector<vector<int> > &clauses,
+        vector<CardConstraint> &cards,
+        int &maxVarIndex,
+        const char *text, size_t len,
+        string &error) {
+    StreamBuffer in(text, len);
+    parse_DIMACS_main(in, clauses, cards);
+    computeMaxVar(clauses, cards, maxVarIndex);
+    error = in.error;
+    return error.empty();
+}
+
+
+void parse_DIMACS_CNF(vector<vector<int> > &clauses,
+        int &maxVarIndex,
+        const char *DIMACS_cnf_file) {
+    vector<CardConstraint> cards;
+    parse_DIMACS_CNF(clauses, cards, maxVarIndex, DIMACS_cnf_file);
+    if (!cards.empty()) {
+        fprintf(stderr, "PARSE ERROR! Cardinality constraints are not supported here: %s\n",
+        DIMACS_cnf_file);
+        exit(3);
+    }
+}
+
+
+static void skipBlank(StreamBuffer &in) {
+    while (*in == ' ' || *in == '\t')
+        ++in;
+}
+
+
+// Reads the variables following `prefix' up to the terminating 0, or
+// skips the line when it does not start with `prefix'.
+static void readProjectionLine(StreamBuffer &in, const char *prefix, vector<int> &vars) {
+    for (const char *p = prefix; *p; ++p) {
+        if (*in != *p) {
+            skipLine(in);
+            return;
         }
+        ++in;
+    }
+    while (true) {
+        int v = parseInt(in);
+        if (v == 0) break;
+        if (v < 0) {
+            in.fail("Negative projection variable", '-');
+            return;
+        }
+        vars.push_back(v);
+    }
+    skipLine(in);
 }
 
+
+void parse_DIMACS_projection(vector<int> &vars,
+        int &declaredVars,
+        const char *DIMACS_cnf_file) {
+    FILE *in = fopen(DIMACS_cnf_file, "r");
+    if (in == NULL) {
+        fprintf(stderr, "ERROR! Could not open file: %s\n",
+        DIMACS_cnf_file);
+        exit(1);
+    }
+    StreamBuffer buf(in);
+    declaredVars = 0;
+    while (true) {
+        skipWhitespace(buf);
+        if (*buf == EOF) break;
+        if (*buf == 'p') {
+            // "p cnf <variables> <clauses>" (also "p cnf+")
+            ++buf;
+            skipBlank(buf);
+            while (*buf >= 'a' && *buf <= 'z') ++buf;
+            if (*buf == '+') ++buf;
+            declaredVars = parseInt(buf);
+            skipLine(buf);
+            continue;
+        }
+        if (*buf != 'c') {
+            skipLine(buf);
+            continue;
+        }
+        ++buf;
+        skipBlank(buf);
+        if (*buf == 'p')
+            readProjectionLine(buf, "p show", vars);
+        else
+            readProjectionLine(buf, "ind", vars);
+    }
+    fclose(in);
+}
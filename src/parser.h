@@ -9,6 +9,8 @@
 #ifndef __PARSER_H__
 #  define __PARSER_H__
 #include <vector>
+#include <string>
+#include <cstddef>
 using std::vector;
 
 
@@ -40,6 +42,59 @@ void parse_DIMACS_CNF(vector<vector<int> > &clauses,
 		      const char *DIMACS_cnf_file);
 
 
+// CardConstraint
+//
+// An at-most-k constraint: at most `k' of the literals in `lit' are
+// true.
+struct CardConstraint {
+    vector<int> lit;
+    int k;
+};
+
+
+// parse_DIMACS_CNF (with cardinality constraints)
+//
+// Same as above, but also accepts the extended "cnf+" format, where a
+// line of literals may end with a comparison instead of 0:
+//
+//     1 -2 3 4 <= 2
+//     1 2 3 >= 1
+//     5 6 7 = 1
+//
+// Every constraint is normalised to at-most-k form and stored in
+// `cards' (`>= k' becomes at-most n-k over the negated literals, `= k'
+// becomes both).  The version without `cards' rejects such input.
+void parse_DIMACS_CNF(vector<vector<int> > &clauses,
+		      vector<CardConstraint> &cards,
+		      int &maxVarIndex,
+		      const char *DIMACS_cnf_file);
+
+
+// parse_DIMACS_text
+//
+// Same as the cnf+ version above, but parses text already in memory
+// (`len' bytes at `text').  Malformed input is not fatal: the function
+// returns false and describes the first problem in `error'.
+bool parse_DIMACS_text(vector<vector<int> > &clauses,
+		       vector<CardConstraint> &cards,
+		       int &maxVarIndex,
+		       const char *text, size_t len,
+		       std::string &error);
+
+
+// parse_DIMACS_projection
+//
+// Reads the projection set of a CNF file, given in comment lines of
+// the form "c p show 1 2 3 0" or "c ind 1 2 3 0" (both forms are used
+// by model counters).  `vars' is left empty when there are none.
+// Negative entries are a parse error.  `declaredVars' receives the
+// variable count of the "p cnf" header (0 if there is none), which may
+// exceed the largest variable used in a clause.
+void parse_DIMACS_projection(vector<int> &vars,
+			     int &declaredVars,
+			     const char *DIMACS_cnf_file);
+
+
 
 
 
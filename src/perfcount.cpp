@@ -0,0 +1,170 @@
+#include "perfcount.h"
+#include <cstring>
+#include <cerrno>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+
+static const char *phaseName[PerfCounters::PHASES] =
+    {"parse", "preprocess", "propagate", "analyse", "heap", "inprocess"};
+
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+    for (int c = 0; c < COUNTERS; ++c)
+        if (fd[c] >= 0)
+            close(fd[c]);
+#endif
+}
+
+
+/// @brief 為呼叫的執行緒開啟計數器群組並開始計數
+/// @return 是否至少有一個計數器可以使用；失敗的原因見 error()
+bool PerfCounters::open()
+{
+#ifdef __linux__
+    static const struct { uint32_t type; uint64_t config; } ev[COUNTERS] = {
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+    // 硬體計數器優先作為群組的領導者，軟體的 task-clock 最後加入
+    static const int order[COUNTERS] = {CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, TIME};
+    for (int c : order)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = ev[c].type;
+        attr.config = ev[c].config;
+        attr.disabled = leader < 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int f = (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+        if (f < 0) {
+            if (err.empty())
+                err = strerror(errno);
+            continue;
+        }
+        if (leader < 0)
+            leader = f;
+        fd[c] = f;
+        slot[c] = opened++;
+    }
+    if (leader < 0)
+        return false;
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+#else
+    err = "not supported on this platform";
+    return false;
+#endif
+}
+
+
+/// @brief 以一次 read 讀取群組中所有計數器的目前值
+bool PerfCounters::sample(uint64_t v[COUNTERS])
+{
+#ifdef __linux__
+    // 格式：計數器數量、啟用時間、實際計數時間、各計數器的值
+    uint64_t buf[3 + COUNTERS];
+    long n = (long)read(leader, buf, sizeof(buf));
+    if (n < (long)((3 + opened) * sizeof(uint64_t)))
+        return false;
+    if (buf[2] < buf[1])
+        multiplexed = true;
+    for (int c = 0; c < COUNTERS; ++c)
+        v[c] = slot[c] >= 0 ? buf[3 + slot[c]] : 0;
+    return true;
+#else
+    (void)v;
+    return false;
+#endif
+}
+
+
+void PerfCounters::begin()
+{
+    if (!sample(start))
+        memset(start, 0, sizeof(start));
+}
+
+
+void PerfCounters::end(int phase)
+{
+    uint64_t now[COUNTERS];
+    if (!sample(now))
+        return;
+    for (int c = 0; c < COUNTERS; ++c)
+        total[phase][c] += now[c] - start[c];
+    ++calls[phase];
+}
+
+
+/// @brief 輸出各階段的計數與 IPC，以及每次傳播、每次衝突的平均值
+void PerfCounters::report(FILE *out, long long propagations, long long conflicts, long long decisions) const
+{
+    // 無法使用的計數器輸出 n/a；perN 不為 0 時輸出平均值
+    auto count = [&](char *buf, size_t sz, int phase, int c, long long perN = 0) {
+        if (slot[c] < 0)
+            snprintf(buf, sz, "n/a");
+        else if (perN > 0)
+            snprintf(buf, sz, "%.3f", (double)total[phase][c] / perN);
+        else
+            snprintf(buf, sz, "%llu", (unsigned long long)total[phase][c]);
+    };
+    char t[32], cy[32], in[32], cm[32], bm[32], ipc[32];
+    fprintf(out, "c perf %-10s %10s %9s %14s %14s %5s %12s %12s\n", "phase", "calls", "time(ms)",
+            "cycles", "instructions", "IPC", "cache-miss", "branch-miss");
+    for (int p = 0; p < PHASES; ++p)
+    {
+        if (calls[p] == 0)
+            continue;
+        if (slot[TIME] < 0)
+            snprintf(t, sizeof(t), "n/a");
+        else
+            snprintf(t, sizeof(t), "%.3f", total[p][TIME] / 1e6);
+        count(cy, sizeof(cy), p, CYCLES);
+        count(in, sizeof(in), p, INSTRUCTIONS);
+        count(cm, sizeof(cm), p, CACHE_MISSES);
+        count(bm, sizeof(bm), p, BRANCH_MISSES);
+        if (slot[CYCLES] < 0 || slot[INSTRUCTIONS] < 0 || total[p][CYCLES] == 0)
+            snprintf(ipc, sizeof(ipc), "n/a");
+        else
+            snprintf(ipc, sizeof(ipc), "%.2f", (double)total[p][INSTRUCTIONS] / total[p][CYCLES]);
+        fprintf(out, "c perf %-10s %10lld %9s %14s %14s %5s %12s %12s\n", phaseName[p], calls[p],
+                t, cy, in, ipc, cm, bm);
+    }
+
+    // 每次傳播、衝突與決策的平均值
+    struct { const char *what; int phase; long long n; } per[] = {
+        {"propagation", PROPAGATE, propagations},
+        {"conflict", ANALYSE, conflicts},
+        {"decision", HEAP, decisions},
+    };
+    for (auto &q : per)
+    {
+        if (q.n <= 0 || calls[q.phase] == 0)
+            continue;
+        count(t, sizeof(t), q.phase, TIME, q.n);
+        count(cy, sizeof(cy), q.phase, CYCLES, q.n);
+        count(in, sizeof(in), q.phase, INSTRUCTIONS, q.n);
+        count(cm, sizeof(cm), q.phase, CACHE_MISSES, q.n);
+        count(bm, sizeof(bm), q.phase, BRANCH_MISSES, q.n);
+        fprintf(out, "c perf per %s: %s ns, %s cycles, %s instructions, %s cache misses, %s branch misses\n",
+                q.what, t, cy, in, cm, bm);
+    }
+    if (!err.empty())
+        fprintf(out, "c perf some counters could not be opened (%s)\n", err.c_str());
+    if (multiplexed)
+        fprintf(out, "c perf counters were multiplexed; counts cover only the time they were scheduled\n");
+}
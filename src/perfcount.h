@@ -0,0 +1,62 @@
+#ifndef __PERFCOUNT_H
+#define __PERFCOUNT_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+using namespace std;
+
+
+// 以 perf_event_open 量測求解各階段的硬體計數器（只計算使用者空間與呼叫的執行緒）。
+// 所有計數器放在同一個群組，每次取樣只需一次 read；無法開啟的計數器（例如容器或
+// 虛擬機中沒有 PMU）會被略過並在報告中標示為 n/a，全部無法開啟時 open 回傳 false。
+class PerfCounters
+{
+public:
+    enum Phase { PARSE, PREPROCESS, PROPAGATE, ANALYSE, HEAP, INPROCESS, PHASES };
+    enum Counter { TIME, CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, COUNTERS };
+
+    ~PerfCounters();
+    bool open();
+    void begin();
+    void end(int phase);
+    void report(FILE *out, long long propagations, long long conflicts, long long decisions) const;
+    const string &error() const { return err; }
+
+protected:
+    int leader = -1;
+    int fd[COUNTERS] = {-1, -1, -1, -1, -1};
+    int slot[COUNTERS] = {-1, -1, -1, -1, -1};  // 在群組讀取結果中的位置（-1 表示無法使用）
+    int opened = 0;
+    bool multiplexed = false;   // 計數器曾被分時共用（數值為估計）
+    uint64_t start[COUNTERS] = {};
+    uint64_t total[PHASES][COUNTERS] = {};
+    long long calls[PHASES] = {};
+    string err;
+
+    bool sample(uint64_t v[COUNTERS]);
+};
+
+
+// 量測一個區塊並累加到指定的階段；pc 為空時不做任何事。區塊不可巢狀
+class PerfScope
+{
+public:
+    PerfScope(PerfCounters *p, int phase) : pc(p), ph(phase)
+    {
+        if (pc)
+            pc->begin();
+    }
+    ~PerfScope()
+    {
+        if (pc)
+            pc->end(ph);
+    }
+
+private:
+    PerfCounters *pc;
+    int ph;
+};
+
+
+#endif
@@ -0,0 +1,145 @@
+#include "placement.h"
+#include "solver.h"
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+/******************************************************
+    NUMA and huge-page placement
+******************************************************/
+
+static const size_t hugePageSize = (size_t)2 << 20;
+
+
+/// @brief 將目前執行緒綁定到行程允許的第 index 個 CPU（超過數量時循環使用）
+/// @param index 工作執行緒編號
+/// @param cpu 綁定的 CPU 編號
+/// @return 是否成功
+bool pinThread(int index, int &cpu)
+{
+    cpu = -1;
+#ifdef __linux__
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return false;
+    int count = CPU_COUNT(&allowed);
+    if (count == 0)
+        return false;
+    int want = index % count;
+    for (int c = 0; c < CPU_SETSIZE; ++c)
+    {
+        if (CPU_ISSET(c, &allowed) && want-- == 0) {
+            cpu = c;
+            break;
+        }
+    }
+    cpu_set_t one;
+    CPU_ZERO(&one);
+    CPU_SET(cpu, &one);
+    // Linux 上 pid 為 0 時只設定呼叫的執行緒
+    return sched_setaffinity(0, sizeof(one), &one) == 0;
+#else
+    (void)index;
+    return false;
+#endif
+}
+
+
+/// @brief 目前執行緒所在的 NUMA 節點
+/// @return 節點編號，無法取得時回傳 -1
+int currentNode()
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+        return (int)node;
+#endif
+    return -1;
+}
+
+
+/// @brief 以 2 MiB 對齊配置，並建議核心以透明大頁提供，減少大配置區的 TLB 失誤
+/// @param bytes 大小
+/// @return 配置的空間（以 freeHuge 釋放）
+void *allocHuge(size_t bytes)
+{
+#ifdef __linux__
+    size_t sz = (bytes + hugePageSize - 1) / hugePageSize * hugePageSize;
+    void *p = aligned_alloc(hugePageSize, sz);
+#ifdef MADV_HUGEPAGE
+    if (p)
+        madvise(p, sz, MADV_HUGEPAGE);
+#endif
+    return p;
+#else
+    return malloc(bytes);
+#endif
+}
+
+
+void freeHuge(void *p)
+{
+    free(p);
+}
+
+
+/// @brief 統計一段記憶體的頁面位於哪個 NUMA 節點（尚未寫入的頁面不計）
+/// @param p 起始位址
+/// @param bytes 大小
+/// @param node 本地節點
+/// @param st 累加的統計
+void countPages(const void *p, size_t bytes, int node, PlacementStats &st)
+{
+    st.bytes += (long long)bytes;
+#if defined(__linux__) && defined(SYS_move_pages)
+    if (p == nullptr || bytes == 0 || node < 0)
+        return;
+    const size_t batch = 1024;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    uintptr_t begin = (uintptr_t)p / page * page, end = (uintptr_t)p + bytes;
+    void *pages[batch];
+    int status[batch];
+    while (begin < end)
+    {
+        size_t n = 0;
+        for (; n < batch && begin < end; ++n, begin += page)
+            pages[n] = (void *)begin;
+        // nodes 為空時 move_pages 只查詢每個頁面所在的節點
+        if (syscall(SYS_move_pages, 0, n, pages, nullptr, status, 0) != 0)
+            return;
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (status[i] == node)
+                ++st.localPages;
+            else if (status[i] >= 0)
+                ++st.remotePages;
+        }
+    }
+#else
+    (void)p;
+    (void)node;
+#endif
+}
+
+
+/// @brief 統計求解器主要資料結構（子句文字配置區、子句、觀察者、變數堆積）的頁面分布
+/// @param node 本地節點
+/// @param st 累加的統計
+void solver::placementStats(int node, PlacementStats &st) const
+{
+    arena.forEachChunk([&](const Lit *p, size_t n) {
+        countPages(p, n * sizeof(Lit), node, st);
+    });
+    countPages(clauses.data(), clauses.capacity() * sizeof(Clause), node, st);
+    countPages(watchers.data(), watchers.capacity() * sizeof(WatcherInfo), node, st);
+    countPages(watchHead.data(), watchHead.capacity() * sizeof(int), node, st);
+    varPriQueue.forEachBuffer([&](const void *p, size_t bytes) {
+        countPages(p, bytes, node, st);
+    });
+}
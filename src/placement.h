@@ -0,0 +1,27 @@
+#ifndef __PLACEMENT_H
+#define __PLACEMENT_H
+
+#include <cstddef>
+
+
+// 平行求解時的記憶體配置。
+// 執行緒綁定到 CPU 後，其後配置並初次寫入的記憶體會落在該 CPU 所在的 NUMA 節點
+// （Linux 的 first-touch 政策），因此每個工作執行緒在綁定後才建立自己的求解器即可。
+// 其他平台上這些函式不做任何事。
+
+// 一組記憶體區段的頁面分布
+struct PlacementStats
+{
+    long long bytes = 0;        // 區段大小總和
+    long long localPages = 0;   // 位於指定節點的頁面數
+    long long remotePages = 0;  // 位於其他節點的頁面數
+};
+
+bool pinThread(int index, int &cpu);
+int currentNode();
+void *allocHuge(size_t bytes);
+void freeHuge(void *p);
+void countPages(const void *p, size_t bytes, int node, PlacementStats &st);
+
+
+#endif
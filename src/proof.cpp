@@ -0,0 +1,88 @@
+#include "proof.h"
+
+ProofWriter::~ProofWriter()
+{
+    close();
+}
+
+
+/// @brief 開啟證明檔並啟動背景寫入執行緒
+/// @param filename 證明檔名稱
+/// @param binaryMode 是否使用二進位 DRAT 格式
+/// @return 是否成功開啟
+bool ProofWriter::open(const char *filename, bool binaryMode)
+{
+    close();
+    out = fopen(filename, binaryMode ? "wb" : "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "ERROR! Could not open proof file: %s\n", filename);
+        return false;
+    }
+    binary = binaryMode;
+    path = filename;
+    buf.assign(bufferSize, 0);
+    pending.assign(bufferSize, 0);
+    used = pendingUsed = 0;
+    hasPending = done = failed = false;
+    writer = thread(&ProofWriter::writerLoop, this);
+    return true;
+}
+
+
+/// @brief 寫出剩餘的緩衝區並關閉證明檔
+/// @return 證明是否完整寫入；失敗時證明檔不完整
+bool ProofWriter::close()
+{
+    if (out == NULL)
+        return true;
+    if (used)
+        handOff();
+    {
+        lock_guard<mutex> lock(mtx);
+        done = true;
+    }
+    cv.notify_all();
+    writer.join();
+    if (fclose(out) != 0)
+        failed = true;
+    out = NULL;
+    if (failed)
+        fprintf(stderr, "ERROR! Could not write proof file: %s (the proof is incomplete)\n", path.c_str());
+    return !failed;
+}
+
+
+/// @brief 將目前的緩衝區交給背景執行緒，並取回已寫完的緩衝區
+void ProofWriter::handOff()
+{
+    unique_lock<mutex> lock(mtx);
+    cv.wait(lock, [this] { return !hasPending; });
+    swap(buf, pending);
+    pendingUsed = used;
+    used = 0;
+    hasPending = true;
+    lock.unlock();
+    cv.notify_all();
+}
+
+
+/// @brief 背景執行緒：等待緩衝區並寫入檔案
+void ProofWriter::writerLoop()
+{
+    unique_lock<mutex> lock(mtx);
+    while (true)
+    {
+        cv.wait(lock, [this] { return hasPending || done; });
+        if (!hasPending)
+            break;
+        lock.unlock();
+        bool ok = failed || fwrite(pending.data(), 1, pendingUsed, out) == pendingUsed;
+        lock.lock();
+        failed |= !ok;
+        hasPending = false;
+        cv.notify_all();
+    }
+    if (fflush(out) != 0)
+        failed = true;
+}
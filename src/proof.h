@@ -0,0 +1,156 @@
+#ifndef __PROOF_H
+#define __PROOF_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "literal.h"
+using namespace std;
+
+
+// DRAT 證明輸出
+// 子句先編碼進大型緩衝區，緩衝區滿了之後交給背景執行緒寫入檔案，
+// 求解器只在緩衝區交換時才可能需要等待。
+class ProofWriter
+{
+public:
+    ProofWriter() {}
+    ~ProofWriter();
+    ProofWriter(const ProofWriter &) = delete;
+    ProofWriter &operator=(const ProofWriter &) = delete;
+
+    bool open(const char *filename, bool binaryMode);
+    bool close();
+
+    inline void add(const Lit *lit, int n);
+    inline void del(const Lit *lit, int n);
+    inline void add(const vector<Lit> &cls);
+    inline void del(const vector<Lit> &cls);
+
+    long long addedCnt = 0;     // 新增的子句數
+    long long deletedCnt = 0;   // 刪除的子句數
+
+    static const size_t bufferSize = 1 << 22;
+
+protected:
+    FILE   *out = nullptr;
+    bool    binary = false;
+    string  path;                   // 證明檔名稱，寫入失敗時回報
+
+    // 求解器寫入的緩衝區
+    vector<char> buf;
+    size_t       used = 0;
+
+    // 交給背景執行緒寫入的緩衝區
+    vector<char> pending;
+    size_t       pendingUsed = 0;
+    bool         hasPending = false;
+    bool         done = false;
+    bool         failed = false;    // 背景執行緒寫入失敗（例如磁碟已滿），之後的內容不再寫入
+
+    mutex              mtx;
+    condition_variable cv;
+    thread             writer;
+
+    inline void reserve(int n);
+    inline void putLit(Lit lit);
+    inline void putClause(char tag, const Lit *lit, int n);
+    void handOff();
+    void writerLoop();
+};
+
+
+/// @brief 確保緩衝區足以容納 n 個文字的子句
+/// @param n 文字數量
+inline void ProofWriter::reserve(int n)
+{
+    // 每個文字最多 12 個字元（文字格式）或 5 個位元組（二進位格式）
+    if (used + (size_t)n * 12 + 16 > buf.size())
+        handOff();
+    if (used + (size_t)n * 12 + 16 > buf.size())
+        buf.resize(used + (size_t)n * 12 + 16);
+}
+
+/// @brief 寫入一個文字
+/// @param lit 文字
+inline void ProofWriter::putLit(Lit lit)
+{
+    if (binary)
+    {
+        // 二進位 DRAT：2*|lit| + (lit<0)，與內部編碼只差在正負號位元相反，以 7 位元可變長度編碼
+        unsigned int u = litNeg(lit);
+        while (u > 127)
+        {
+            buf[used++] = (char)(128 | (u & 127));
+            u >>= 7;
+        }
+        buf[used++] = (char)u;
+        return;
+    }
+    char tmp[12];
+    int len = 0;
+    unsigned int u = (unsigned int)litVar(lit);
+    do {
+        tmp[len++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (!litSign(lit))
+        buf[used++] = '-';
+    while (len)
+        buf[used++] = tmp[--len];
+    buf[used++] = ' ';
+}
+
+/// @brief 寫入一個子句（新增或刪除）
+/// @param tag 'a' 表示新增，'d' 表示刪除
+/// @param lit 子句文字
+/// @param n 文字數量
+inline void ProofWriter::putClause(char tag, const Lit *lit, int n)
+{
+    reserve(n);
+    if (binary)
+    {
+        buf[used++] = tag;
+        for (int i=0; i<n; ++i)
+            putLit(lit[i]);
+        buf[used++] = 0;
+        return;
+    }
+    if (tag == 'd')
+    {
+        buf[used++] = 'd';
+        buf[used++] = ' ';
+    }
+    for (int i=0; i<n; ++i)
+        putLit(lit[i]);
+    buf[used++] = '0';
+    buf[used++] = '\n';
+}
+
+inline void ProofWriter::add(const Lit *lit, int n)
+{
+    ++addedCnt;
+    putClause('a', lit, n);
+}
+
+inline void ProofWriter::del(const Lit *lit, int n)
+{
+    ++deletedCnt;
+    putClause('d', lit, n);
+}
+
+inline void ProofWriter::add(const vector<Lit> &cls)
+{
+    add(cls.data(), (int)cls.size());
+}
+
+inline void ProofWriter::del(const vector<Lit> &cls)
+{
+    del(cls.data(), (int)cls.size());
+}
+
+#endif
@@ -0,0 +1,214 @@
+#include "sampler.h"
+#include <algorithm>
+
+// 只有 x86-64 才提供 AVX2 版本；GCC/Clang 以 target 屬性個別編譯該函式，
+// 因此不需要對整個專案開啟 -mavx2，執行時再依 CPU 決定是否使用。
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  include <immintrin.h>
+#  define SAMPLER_AVX2 1
+#  define SAMPLER_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#  include <immintrin.h>
+#  include <intrin.h>
+#  define SAMPLER_AVX2 1
+#  define SAMPLER_TARGET_AVX2
+#else
+#  define SAMPLER_AVX2 0
+#endif
+
+
+/// @brief 檢查 CPU（以及作業系統）是否支援 AVX2
+/// @return 是否支援
+bool BitSampler::cpuHasAVX2()
+{
+#if SAMPLER_AVX2 && defined(__GNUC__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif SAMPLER_AVX2
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+
+/// @brief 初始化取樣器
+/// @param maxVarIndex 最大變數索引
+/// @param seed 亂數種子
+void BitSampler::init(int maxVarIndex, uint64_t seed)
+{
+    *this = BitSampler();
+    maxVar = maxVarIndex;
+    rng = seed ? seed : 1;
+    clsStart.push_back(0);
+    fixedVal.assign(maxVar+1, -1);
+    useAVX2 = cpuHasAVX2();
+}
+
+
+void BitSampler::addClause(const int *lit, int n)
+{
+    lits.insert(lits.end(), lit, lit + n);
+    clsStart.push_back((int)lits.size());
+}
+
+void BitSampler::addClause(const vector<int> &cls)
+{
+    addClause(cls.data(), (int)cls.size());
+}
+
+
+/// @brief 固定變數的值（例如第 0 層的賦值）
+/// @param vid 變數 ID
+/// @param val 變數的值
+void BitSampler::fix(int vid, bool val)
+{
+    fixedVal[vid] = val;
+}
+
+
+/// @brief 產生每個變數的隨機字組，固定的變數為全 0 或全 1
+/// @param words words[v*lanes + l] 為變數 v 的第 l 個字組
+void BitSampler::randomWords(vector<uint64_t> &words)
+{
+    words.assign((size_t)(maxVar+1) * lanes, 0);
+    for (int v=1; v<=maxVar; ++v)
+    {
+        for (int l=0; l<lanes; ++l)
+        {
+            words[(size_t)v*lanes + l] =
+                fixedVal[v] == -1 ? nextRand() : (fixedVal[v] ? ~0ULL : 0ULL);
+        }
+    }
+}
+
+
+/// @brief 位元切片計數器所需的位元數（足以表示子句總數）
+int BitSampler::counterBits() const
+{
+    int numCls = (int)clsStart.size() - 1;
+    int bits = 1;
+    while (bits < 31 && (1 << bits) <= numCls)
+        ++bits;
+    return bits;
+}
+
+
+/// @brief 以 64 位元字組逐一評估所有子句，累計每組賦值的不滿足子句數
+/// @param words 變數字組
+/// @param cnt 位元切片計數器，cnt[k*lanes + l] 為第 l 個字組中所有賦值計數的第 k 個位元
+/// @param bits 計數器位元數
+void BitSampler::evalScalar(const vector<uint64_t> &words, vector<uint64_t> &cnt, int bits) const
+{
+    cnt.assign((size_t)bits * lanes, 0);
+    int numCls = (int)clsStart.size() - 1;
+    for (int cid=0; cid<numCls; ++cid)
+    {
+        uint64_t sat[lanes] = {};
+        for (int i=clsStart[cid]; i<clsStart[cid+1]; ++i)
+        {
+            int lit = lits[i];
+            const uint64_t *w = &words[(size_t)abs(lit) * lanes];
+            for (int l=0; l<lanes; ++l)
+                sat[l] |= (lit > 0 ? w[l] : ~w[l]);
+        }
+        // 將不滿足的位元加到計數器上（逐位元進位）
+        for (int l=0; l<lanes; ++l)
+        {
+            uint64_t carry = ~sat[l];
+            for (int k=0; k<bits && carry; ++k)
+            {
+                uint64_t t = cnt[(size_t)k*lanes + l] & carry;
+                cnt[(size_t)k*lanes + l] ^= carry;
+                carry = t;
+            }
+        }
+    }
+}
+
+
+#if SAMPLER_AVX2
+/// @brief 以 256 位元向量評估所有子句（AVX2 版本）
+SAMPLER_TARGET_AVX2
+void BitSampler::evalAVX2(const vector<uint64_t> &words, vector<uint64_t> &cnt, int bits) const
+{
+    cnt.assign((size_t)bits * lanes, 0);
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    int numCls = (int)clsStart.size() - 1;
+    for (int cid=0; cid<numCls; ++cid)
+    {
+        __m256i sat = _mm256_setzero_si256();
+        for (int i=clsStart[cid]; i<clsStart[cid+1]; ++i)
+        {
+            int lit = lits[i];
+            __m256i w = _mm256_loadu_si256((const __m256i *)&words[(size_t)abs(lit) * lanes]);
+            if (lit < 0)
+                w = _mm256_xor_si256(w, ones);
+            sat = _mm256_or_si256(sat, w);
+        }
+        __m256i carry = _mm256_xor_si256(sat, ones);
+        for (int k=0; k<bits && !_mm256_testz_si256(carry, carry); ++k)
+        {
+            __m256i *p = (__m256i *)&cnt[(size_t)k * 4];
+            __m256i c = _mm256_loadu_si256(p);
+            _mm256_storeu_si256(p, _mm256_xor_si256(c, carry));
+            carry = _mm256_and_si256(c, carry);
+        }
+    }
+}
+#else
+void BitSampler::evalAVX2(const vector<uint64_t> &words, vector<uint64_t> &cnt, int bits) const
+{
+    evalScalar(words, cnt, bits);
+}
+#endif
+
+
+/// @brief 評估多輪隨機賦值，回傳不滿足子句數最少的賦值
+/// @param rounds 輪數，每輪評估 256 組賦值
+/// @param best 最佳賦值，best[v] 為變數 v 的值
+/// @return 最佳賦值的不滿足子句數
+int BitSampler::sample(int rounds, vector<char> &best)
+{
+    int bits = counterBits();
+    int bestCnt = -1;
+    vector<uint64_t> words, cnt;
+    best.assign(maxVar+1, 0);
+
+    for (int r=0; r<rounds; ++r)
+    {
+        randomWords(words);
+        if (useAVX2)
+            evalAVX2(words, cnt, bits);
+        else
+            evalScalar(words, cnt, bits);
+        evaluated += 64 * lanes;
+
+        // 由位元切片計數器解出每組賦值的計數
+        for (int l=0; l<lanes; ++l)
+        {
+            for (int j=0; j<64; ++j)
+            {
+                int c = 0;
+                for (int k=0; k<bits; ++k)
+                    c |= (int)((cnt[(size_t)k*lanes + l] >> j) & 1) << k;
+                if (bestCnt != -1 && c >= bestCnt)
+                    continue;
+                bestCnt = c;
+                for (int v=1; v<=maxVar; ++v)
+                    best[v] = (char)((words[(size_t)v*lanes + l] >> j) & 1);
+            }
+        }
+    }
+    return bestCnt;
+}
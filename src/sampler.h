@@ -0,0 +1,60 @@
+#ifndef __SAMPLER_H
+#define __SAMPLER_H
+
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+using namespace std;
+
+
+// 位元平行的隨機賦值取樣
+// 每個變數以 4 個 64 位元字組（256 位元）同時表示 256 組隨機賦值，
+// 一次走訪所有子句即可評估所有賦值，並以位元切片計數器累計各組賦值的不滿足子句數。
+// AVX2 版本一次處理 256 位元，純量版本逐個 64 位元字組處理；兩者使用相同的亂數，
+// 因此相同的種子在任何 CPU 上都得到相同的賦值。
+class BitSampler
+{
+public:
+    void init(int maxVarIndex, uint64_t seed = 1);
+    void addClause(const int *lit, int n);
+    void addClause(const vector<int> &cls);
+    void fix(int vid, bool val);
+
+    int sample(int rounds, vector<char> &best);
+
+    static bool cpuHasAVX2();
+
+    static const int lanes = 4;     // 每個變數的 64 位元字組數
+
+    bool      useAVX2 = false;      // 是否使用 AVX2 版本（init 時依 CPU 決定）
+    long long evaluated = 0;        // 已評估的賦值數
+
+protected:
+    int maxVar = 0;
+    uint64_t rng = 1;
+
+    // 子句以 CSR 形式串接儲存
+    vector<int> lits;
+    vector<int> clsStart;
+
+    vector<signed char> fixedVal;   // 固定的變數值（-1 表示未固定）
+
+    inline uint64_t nextRand();
+    void randomWords(vector<uint64_t> &words);
+    int  counterBits() const;
+
+    void evalScalar(const vector<uint64_t> &words, vector<uint64_t> &cnt, int bits) const;
+    void evalAVX2(const vector<uint64_t> &words, vector<uint64_t> &cnt, int bits) const;
+};
+
+
+/// @brief xorshift64* 亂數
+inline uint64_t BitSampler::nextRand()
+{
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return rng * 0x2545F4914F6CDD1DULL;
+}
+
+#endif
@@ -0,0 +1,414 @@
+#include "server.h"
+#include "solver.h"
+#include "placement.h"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <memory>
+#ifdef _WIN32
+#include <io.h>
+#define read _read
+#define write _write
+#else
+#include <unistd.h>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+using namespace std;
+
+
+namespace {
+
+const size_t maxJobBytes = (size_t)1 << 30;  // 單一請求的 CNF 大小上限
+const long long statSample = 64;             // 每隔多少個工作取樣一次頁面分布
+
+/// @brief 一個用戶端連線：讀取請求與寫回結果的檔案描述子
+struct Conn
+{
+    int in, out;
+    bool ownFd;               // 結束時是否關閉（socket 連線）
+    mutex writeLock;          // 多個工作執行緒寫回同一連線時互斥
+
+    Conn(int i, int o, bool own) : in(i), out(o), ownFd(own) {}
+    ~Conn()
+    {
+#ifndef _WIN32
+        if (ownFd)
+            close(in);
+#endif
+    }
+};
+
+/// @brief 一個求解工作
+struct Job
+{
+    shared_ptr<Conn> conn;
+    string id;
+    string text;              // DIMACS 文字
+    int timeout;
+    int mode;
+    uint64_t seed;
+};
+
+/// @brief 工作佇列（多個連線寫入，多個工作執行緒取出）
+class JobQueue
+{
+public:
+    void push(Job &&job)
+    {
+        {
+            lock_guard<mutex> lk(m);
+            q.push_back(move(job));
+        }
+        cv.notify_one();
+    }
+
+    /// @brief 取出一個工作，佇列關閉且清空時回傳 false
+    bool pop(Job &job)
+    {
+        unique_lock<mutex> lk(m);
+        cv.wait(lk, [this] { return !q.empty() || closed; });
+        if (q.empty())
+            return false;
+        job = move(q.front());
+        q.pop_front();
+        return true;
+    }
+
+    void close()
+    {
+        {
+            lock_guard<mutex> lk(m);
+            closed = true;
+        }
+        cv.notify_all();
+    }
+
+private:
+    mutex m;
+    condition_variable cv;
+    deque<Job> q;
+    bool closed = false;
+};
+
+/// @brief 一個工作執行緒的統計
+struct WorkerStats
+{
+    int cpu = -1;             // 綁定的 CPU（-1 表示未綁定）
+    int node = -1;            // 最近一次取樣時所在的 NUMA 節點
+    long long jobs = 0;       // 完成的工作數
+    PlacementStats mem;       // 最近一次取樣的求解器記憶體頁面分布
+};
+
+/// @brief 連線與工作執行緒共用的狀態
+struct Pool
+{
+    const ServerConfig &cfg;
+    JobQueue queue;
+    mutex statsLock;
+    vector<WorkerStats> stats;
+
+    Pool(const ServerConfig &c, int workers) : cfg(c), stats(workers) {}
+};
+
+/// @brief 以固定大小的緩衝區從檔案描述子讀取行與定長資料
+class FdReader
+{
+public:
+    FdReader(int f) : fd(f), buf(1 << 16) {}
+
+    bool readLine(string &line)
+    {
+        line.clear();
+        while (true)
+        {
+            if (pos == size && !fill())
+                return !line.empty();
+            char *begin = buf.data() + pos;
+            char *nl = (char *)memchr(begin, '\n', size - pos);
+            if (nl) {
+                line.append(begin, nl);
+                pos += nl - begin + 1;
+                return true;
+            }
+            line.append(begin, buf.data() + size);
+            pos = size;
+        }
+    }
+
+    bool readExact(string &out, size_t n)
+    {
+        out.resize(n);
+        size_t got = 0;
+        while (got < n)
+        {
+            if (pos == size && !fill())
+                return false;
+            size_t k = min(n - got, size - pos);
+            memcpy(&out[got], buf.data() + pos, k);
+            got += k;
+            pos += k;
+        }
+        return true;
+    }
+
+private:
+    int fd;
+    vector<char> buf;
+    size_t pos = 0, size = 0;
+
+    bool fill()
+    {
+        long n;
+        do {
+            n = (long)read(fd, buf.data(), (unsigned)buf.size());
+        } while (n < 0 && errno == EINTR);
+        pos = 0;
+        size = n > 0 ? (size_t)n : 0;
+        return n > 0;
+    }
+};
+
+
+void writeAll(int fd, const string &s)
+{
+    size_t done = 0;
+    while (done < s.size())
+    {
+        long n = (long)write(fd, s.data() + done, (unsigned)(s.size() - done));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return;
+        done += (size_t)n;
+    }
+}
+
+
+void reply(Conn &conn, const string &s)
+{
+    lock_guard<mutex> lk(conn.writeLock);
+    writeAll(conn.out, s);
+}
+
+
+/// @brief 工作執行緒：求解器與解析用的容器在工作之間重複使用。
+///        需要綁定 CPU 時先綁定再建立求解器，其記憶體因 first-touch 而配置在本地節點
+void worker(Pool &pool, int index)
+{
+    WorkerStats my;
+    if (pool.cfg.pin && !pinThread(index, my.cpu))
+        fprintf(stderr, "WARNING! Could not pin worker %d to a CPU\n", index);
+
+    solver yasat;
+    yasat.hugePages = pool.cfg.hugePages;
+    vector<vector<int>> raw;
+    vector<CardConstraint> cards;
+    string error, out;
+    char tmp[32];
+    Job job;
+    while (pool.queue.pop(job))
+    {
+        TRACE_SCOPE("job");
+        auto start = chrono::steady_clock::now();
+        raw.clear();
+        cards.clear();
+        int maxVar;
+        bool parsed;
+        {
+            TRACE_SCOPE("parse");
+            parsed = parse_DIMACS_text(raw, cards, maxVar, job.text.data(), job.text.size(), error);
+        }
+        if (!parsed)
+        {
+            reply(*job.conn, "s " + job.id + " ERROR " + error + "\n");
+            job.conn.reset();
+            continue;
+        }
+        yasat.seed = job.seed;
+        yasat.params = pool.cfg.params;
+        yasat.init(raw, cards, maxVar, job.mode);
+        yasat.timeout = job.timeout;
+        yasat.solve();
+        const vector<int> &res = yasat.result();
+        long long usec = chrono::duration_cast<chrono::microseconds>(
+            chrono::steady_clock::now() - start).count();
+
+        out = "s " + job.id;
+        out += res[0] == -1 ? " UNKNOWN " : (res[0] ? " SATISFIABLE " : " UNSATISFIABLE ");
+        out += to_string(usec);
+        out += '\n';
+        if (res[0] > 0)
+        {
+            out += 'v';
+            for (size_t i = 1; i < res.size(); ++i)
+            {
+                int len = snprintf(tmp, sizeof(tmp), " %d", res[i]);
+                out.append(tmp, len);
+            }
+            out += " 0\n";
+        }
+        reply(*job.conn, out);
+        // 最後一個工作完成後才關閉連線
+        job.conn.reset();
+
+        if (my.jobs++ % statSample == 0) {
+            my.node = currentNode();
+            my.mem = PlacementStats();
+            yasat.placementStats(my.node, my.mem);
+        }
+        lock_guard<mutex> lk(pool.statsLock);
+        pool.stats[index] = my;
+    }
+}
+
+
+/// @brief 回覆每個工作執行緒的統計
+void replyStats(Conn &conn, Pool &pool)
+{
+    string out;
+    char tmp[256];
+    {
+        lock_guard<mutex> lk(pool.statsLock);
+        out = "s - STATS " + to_string(pool.stats.size()) + "\n";
+        for (size_t i = 0; i < pool.stats.size(); ++i)
+        {
+            const WorkerStats &w = pool.stats[i];
+            int len = snprintf(tmp, sizeof(tmp), "w %zu cpu=%d node=%d jobs=%lld bytes=%lld local=%lld remote=%lld\n",
+                               i, w.cpu, w.node, w.jobs, w.mem.bytes, w.mem.localPages, w.mem.remotePages);
+            out.append(tmp, len);
+        }
+    }
+    reply(conn, out);
+}
+
+
+/// @brief 讀取一個連線的所有請求並放入佇列，直到連線結束或收到 quit
+void serveConn(shared_ptr<Conn> conn, Pool &pool)
+{
+    FdReader rd(conn->in);
+    string line;
+    char id[256], opt[64];
+    while (rd.readLine(line))
+    {
+        if (line.empty())
+            continue;
+        if (line == "quit")
+            break;
+        if (line == "stats") {
+            replyStats(*conn, pool);
+            continue;
+        }
+
+        unsigned long long bytes = 0;
+        int used = 0;
+        if (sscanf(line.c_str(), "solve %255s %llu%n", id, &bytes, &used) < 2) {
+            reply(*conn, "s - ERROR bad request\n");
+            continue;
+        }
+        Job job;
+        job.conn = conn;
+        job.id = id;
+        job.timeout = pool.cfg.timeout;
+        job.mode = pool.cfg.mode;
+        job.seed = pool.cfg.seed;
+        // 每個工作可以覆寫超時、執行模式與亂數種子
+        const char *p = line.c_str() + used;
+        int n = 0;
+        while (sscanf(p, " %63s%n", opt, &n) == 1)
+        {
+            p += n;
+            if (strncmp(opt, "timeout=", 8) == 0)
+                job.timeout = atoi(opt + 8);
+            else if (strncmp(opt, "mode=", 5) == 0)
+                job.mode = atoi(opt + 5);
+            else if (strncmp(opt, "seed=", 5) == 0)
+                job.seed = strtoull(opt + 5, nullptr, 10);
+        }
+        // 無法略過過大的內容而與下一個請求對齊，直接結束連線
+        if (bytes > maxJobBytes) {
+            reply(*conn, "s " + job.id + " ERROR request too large\n");
+            break;
+        }
+        if (!rd.readExact(job.text, (size_t)bytes))
+            break;
+        pool.queue.push(move(job));
+    }
+}
+
+}  // namespace
+
+
+/// @brief 執行批次求解伺服器
+/// @param cfg 伺服器設定；socketPath 為 nullptr 時使用 stdin/stdout，輸入結束後等待所有工作完成再返回
+/// @return 結束碼
+int runServer(const ServerConfig &cfg)
+{
+    int workers = cfg.workers;
+    if (workers <= 0)
+        workers = (int)max(1u, thread::hardware_concurrency());
+
+    Pool pool(cfg, workers);
+    vector<thread> threads;
+    for (int i = 0; i < workers; ++i)
+        threads.emplace_back(worker, ref(pool), i);
+    // 等待所有工作完成並結束工作執行緒
+    auto shutdown = [&](int ret) {
+        pool.queue.close();
+        for (auto &th : threads)
+            th.join();
+        return ret;
+    };
+
+    if (!cfg.socketPath)
+    {
+        serveConn(make_shared<Conn>(0, 1, false), pool);
+        return shutdown(0);
+    }
+
+#ifdef _WIN32
+    fprintf(stderr, "ERROR! Unix domain sockets are not supported on this platform\n");
+    return shutdown(1);
+#else
+    // 用戶端中途斷線時寫回結果不應結束整個伺服器
+    signal(SIGPIPE, SIG_IGN);
+
+    const char *socketPath = cfg.socketPath;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (fd < 0 || strlen(socketPath) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "ERROR! Could not create socket: %s\n", socketPath);
+        return shutdown(1);
+    }
+    strcpy(addr.sun_path, socketPath);
+    unlink(socketPath);
+    if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 64) < 0) {
+        fprintf(stderr, "ERROR! Could not listen on socket: %s (%s)\n", socketPath, strerror(errno));
+        close(fd);
+        return shutdown(1);
+    }
+    fprintf(stderr, "c listening on %s with %d workers\n", socketPath, workers);
+
+    while (true)
+    {
+        int cfd = accept(fd, nullptr, nullptr);
+        if (cfd < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        thread(serveConn, make_shared<Conn>(cfd, cfd, true), ref(pool)).detach();
+    }
+    close(fd);
+    return shutdown(0);
+#endif
+}
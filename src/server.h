@@ -0,0 +1,35 @@
+#ifndef __SERVER_H
+#define __SERVER_H
+
+#include <cstdint>
+#include "params.h"
+
+// 伺服器設定
+struct ServerConfig
+{
+    const char *socketPath = nullptr;   // Unix domain socket 路徑；nullptr 表示使用 stdin/stdout
+    int         workers = 0;            // 工作執行緒數量（0 表示使用所有核心）
+    int         mode = 20;              // 預設執行模式
+    int         timeout = 10;           // 預設超時時間（秒）
+    uint64_t    seed = 1;               // 預設亂數種子
+    bool        pin = false;            // 將每個工作執行緒綁定到一個 CPU，其求解器配置在本地 NUMA 節點
+    bool        hugePages = false;      // 以透明大頁配置子句文字
+    SolverParams params;                // 所有請求共用的求解參數
+};
+
+// 批次求解伺服器：從 stdin（socketPath 為空）或 Unix domain socket 接收 CNF，
+// 由固定數量的工作執行緒求解，結果完成後立即寫回。
+//
+// 請求：  solve <id> <bytes> [timeout=<sec>] [mode=<n>] [seed=<n>]\n 後接 <bytes> 位元組的 DIMACS（或 cnf+）文字
+//         stats\n 查詢每個工作執行緒的統計
+//         quit\n 結束連線
+// 回應：  s <id> SATISFIABLE <usec>\n v <lits> 0\n
+//         s <id> UNSATISFIABLE <usec>\n
+//         s <id> UNKNOWN <usec>\n（超時）
+//         s <id> ERROR <message>\n
+//         s - STATS <n>\n 後接 n 行 w <i> cpu=<c> node=<n> jobs=<j> bytes=<b> local=<pages> remote=<pages>
+// 回應依完成順序輸出，以 id 對應請求。
+int runServer(const ServerConfig &cfg);
+
+
+#endif
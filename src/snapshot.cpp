@@ -0,0 +1,206 @@
+#include "snapshot.h"
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+
+// 檔案格式：8 位元組的魔術字串、各欄位依 SolverSnapshot 的宣告順序（本機位元組序，
+// 向量先寫 64 位元的元素數量），最後是前面所有位元組的 FNV-1a 校驗碼
+static const char magic[8] = {'S', 'A', 'T', 'S', 'N', 'A', 'P', '1'};
+
+
+static uint64_t checksum(const char *p, size_t n)
+{
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < n; ++i)
+        h = (h ^ (unsigned char)p[i]) * 0x100000001B3ULL;
+    return h;
+}
+
+
+namespace {
+
+struct Writer
+{
+    string buf;
+
+    template<class T> void put(const T &v)
+    {
+        static_assert(is_trivially_copyable<T>::value, "plain data only");
+        buf.append((const char *)&v, sizeof(T));
+    }
+    template<class T> void putVec(const vector<T> &v)
+    {
+        put((uint64_t)v.size());
+        if (!v.empty())
+            buf.append((const char *)v.data(), v.size() * sizeof(T));
+    }
+};
+
+struct Reader
+{
+    const string &buf;
+    size_t pos;
+    size_t end;
+    bool ok = true;
+
+    Reader(const string &b, size_t start, size_t stop) : buf(b), pos(start), end(stop) {}
+
+    template<class T> void get(T &v)
+    {
+        if (!ok || end - pos < sizeof(T)) {
+            ok = false;
+            return;
+        }
+        memcpy(&v, buf.data() + pos, sizeof(T));
+        pos += sizeof(T);
+    }
+    template<class T> void getVec(vector<T> &v)
+    {
+        uint64_t n = 0;
+        get(n);
+        if (!ok || n > (end - pos) / sizeof(T)) {
+            ok = false;
+            return;
+        }
+        v.resize((size_t)n);
+        if (n)
+            memcpy(v.data(), buf.data() + pos, (size_t)n * sizeof(T));
+        pos += (size_t)n * sizeof(T);
+    }
+};
+
+}  // namespace
+
+
+// 依宣告順序讀寫的所有欄位；寫入與讀取共用同一份清單，兩者不會不一致
+#define SNAPSHOT_FIELDS(X, V) \
+    X(formula) X(mode) X(seed) X(maxVar) X(elapsed) X(rng) \
+    X(conflicts) X(decisions) X(propagations) X(restarts) \
+    X(vivifiedLits) X(minimizedLits) X(rephases) X(simplifies) \
+    X(simpRemovedCls) X(simpRemovedLits) \
+    X(gaussProps) X(gaussConflicts) X(cardProps) X(cardConflicts) X(lsBestUnsat) \
+    X(nextRestart) X(nextVivify) X(lastVivifyProps) X(nextSimplify) X(nextRephase) \
+    V(trail) V(learntLits) V(learntLbd) V(learntVivified) V(phase) \
+    X(heap.nowT) X(heap.sz) V(heap.pri) V(heap.var) V(heap.lastEvalT) V(heap.signCnt)
+
+
+/// @brief 寫入快照；先寫到暫存檔再改名取代，中途被中斷時不會留下不完整的快照
+/// @param filename 快照檔名
+/// @return 是否成功
+bool SolverSnapshot::save(const char *filename) const
+{
+    Writer w;
+    w.buf.append(magic, sizeof(magic));
+#define PUT(f) w.put(f);
+#define PUT_VEC(f) w.putVec(f);
+    SNAPSHOT_FIELDS(PUT, PUT_VEC)
+#undef PUT
+#undef PUT_VEC
+    w.put(checksum(w.buf.data(), w.buf.size()));
+
+    string tmp = string(filename) + ".tmp";
+    FILE *out = fopen(tmp.c_str(), "wb");
+    if (out == NULL)
+        return false;
+    bool ok = fwrite(w.buf.data(), 1, w.buf.size(), out) == w.buf.size();
+    ok &= fclose(out) == 0;
+    if (ok)
+        ok = rename(tmp.c_str(), filename) == 0;
+    if (!ok)
+        remove(tmp.c_str());
+    return ok;
+}
+
+
+/// @brief 讀取並檢查快照
+/// @param filename 快照檔名
+/// @param err 失敗的原因
+/// @return 是否成功
+bool SolverSnapshot::load(const char *filename, string &err)
+{
+    FILE *in = fopen(filename, "rb");
+    if (in == NULL) {
+        err = "could not open file";
+        return false;
+    }
+    string buf;
+    char chunk[1 << 16];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0)
+        buf.append(chunk, n);
+    fclose(in);
+
+    uint64_t sum;
+    if (buf.size() < sizeof(magic) + sizeof(sum) || memcmp(buf.data(), magic, sizeof(magic)) != 0) {
+        err = "not a solver snapshot";
+        return false;
+    }
+    size_t body = buf.size() - sizeof(sum);
+    memcpy(&sum, buf.data() + body, sizeof(sum));
+    if (sum != checksum(buf.data(), body)) {
+        err = "checksum mismatch (truncated or corrupted)";
+        return false;
+    }
+
+    Reader r(buf, sizeof(magic), body);
+#define GET(f) r.get(f);
+#define GET_VEC(f) r.getVec(f);
+    SNAPSHOT_FIELDS(GET, GET_VEC)
+#undef GET
+#undef GET_VEC
+    if (!r.ok || r.pos != body) {
+        err = "malformed snapshot";
+        return false;
+    }
+
+    // 文字與陣列大小必須符合變數數量，續跑時才能直接使用
+    Lit maxLit = (Lit)(2 * maxVar + 1);
+    bool valid = maxVar > 0 && (int)phase.size() == maxVar + 1 &&
+                 learntLbd.size() == learntVivified.size() &&
+                 (learntLits.empty() || learntLits.back() == 0);
+    for (Lit l : trail)
+        valid &= l >= 2 && l <= maxLit;
+    size_t ends = 0;
+    for (Lit l : learntLits)
+    {
+        valid &= l == 0 || (l >= 2 && l <= maxLit);
+        ends += l == 0;
+    }
+    valid &= ends == learntLbd.size();
+    size_t heapSz = (size_t)maxVar + 4;
+    valid &= heap.pri.size() == heapSz && heap.var.size() == heapSz &&
+             heap.lastEvalT.size() == heapSz && heap.signCnt.size() == heapSz;
+    if (!valid) {
+        err = "inconsistent snapshot contents";
+        return false;
+    }
+    return true;
+}
+
+
+/// @brief 依子句順序計算的公式雜湊。預處理的結果與子句順序有關，
+///        因此這裡不使用與順序無關的 hashFormula
+uint64_t snapshotFormulaHash(const vector<vector<int>> &clauses, const vector<CardConstraint> &cards,
+                             int maxVarIndex)
+{
+    uint64_t h = 0xCBF29CE484222325ULL;
+    auto mix = [&](uint64_t v) {
+        h = (h ^ v) * 0x100000001B3ULL;
+        h ^= h >> 29;
+    };
+    mix((uint64_t)maxVarIndex);
+    for (auto &cls : clauses)
+    {
+        for (int l : cls)
+            mix((uint32_t)l);
+        mix(0);
+    }
+    for (auto &cd : cards)
+    {
+        for (int l : cd.lit)
+            mix((uint32_t)l);
+        mix(0x100000000ULL + (uint32_t)cd.k);
+    }
+    return h;
+}
@@ -0,0 +1,50 @@
+#ifndef __SNAPSHOT_H
+#define __SNAPSHOT_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "literal.h"
+#include "parser.h"
+#include "heap.h"
+using namespace std;
+
+
+// 求解狀態的快照：在第 0 層取得，之後可在另一個行程中接續搜尋。
+// 原始子句不存入快照，續跑時以相同的 CNF、執行模式與亂數種子重新初始化，
+// 預處理的結果與取快照時相同，快照中的學習子句與第 0 層賦值才會成立；
+// formula 記錄依子句順序計算的雜湊，用來確認輸入沒有改變。
+struct SolverSnapshot
+{
+    // 產生快照時的輸入與設定
+    uint64_t formula = 0;           // snapshotFormulaHash 的結果
+    int mode = 0;                   // 執行模式
+    uint64_t seed = 1;              // 亂數種子
+    int maxVar = 0;                 // 最大變數索引
+    long long elapsed = 0;          // 累計的搜尋時間（秒，包含先前的行程）
+
+    // 搜尋狀態
+    uint64_t rng = 1;
+    long long conflicts = 0, decisions = 0, propagations = 0, restarts = 0;
+    long long vivifiedLits = 0, minimizedLits = 0, rephases = 0, simplifies = 0;
+    long long simpRemovedCls = 0, simpRemovedLits = 0;
+    long long gaussProps = 0, gaussConflicts = 0, cardProps = 0, cardConflicts = 0;
+    int lsBestUnsat = -1;
+    long long nextRestart = 0, nextVivify = 0, lastVivifyProps = 0;
+    long long nextSimplify = 0, nextRephase = 0;
+
+    vector<Lit> trail;              // 第 0 層的賦值
+    vector<Lit> learntLits;         // 學習子句（以文字 0 結尾串接，已移除第 0 層為假的文字）
+    vector<int> learntLbd;          // 每個學習子句的 LBD
+    vector<char> learntVivified;    // 每個學習子句是否已做過 vivification
+    vector<int> phase;              // 儲存的相位（以變數索引）
+    VarHeap::State heap;            // 變數優先級堆積
+
+    bool save(const char *filename) const;
+    bool load(const char *filename, string &err);
+};
+
+uint64_t snapshotFormulaHash(const vector<vector<int>> &clauses, const vector<CardConstraint> &cards,
+                             int maxVarIndex);
+
+#endif
@@ -1,26 +1,29 @@
 #include "solver.h"
 
-// Return result
-vector<int> solver::result()
+// Return result (kept in a solver-owned buffer)
+const vector<int> &solver::result()
 {
     if (!sat) {
-        if(runTime>timeout)
-            return vector<int>(1, -1);
-        else
-            return vector<int>(1, 0);
+        model.assign(1, (runTime>timeout || interrupted) ? -1 : 0);
+        return model;
     }
 
-    vector<int> ret(maxVarIndex+1, 1);
+    model.assign(maxVarIndex+1, 1);
     for(int i=1; i<=maxVarIndex; ++i)
-        ret[i] = var.getVal(i) ? i : -i;
-    return ret;
+        model[i] = var.getVal(i) ? i : -i;
+    // 修正被 BCE/CCE 刪除的子句
+    extendModel(model);
+    // 不輸出 UNSAT core 的選擇變數
+    if (trackCore)
+        model.resize(coreVars+1);
+    return model;
 }
 
 void solver::printCNF()
 {
     for(auto &cls : clauses) {
         for(int i=0; i<cls.size(); ++i)
-            printf("%d ", cls.getLit(i));
+            printf("%d ", toDimacs(cls.getLit(i)));
         printf("0\n");
     }
 }
@@ -40,18 +43,42 @@ int solver::getClauseCount()
     return (int)clauses.size();
 }
 
+/// @brief 開啟 DRAT 證明輸出，需在 init 之前呼叫才能記錄初始化時的簡化
+/// @param filename 證明檔名稱
+/// @param binary 是否使用二進位 DRAT 格式
+/// @return 是否成功開啟
+bool solver::setProof(const char *filename, bool binary)
+{
+    proof.reset(new ProofWriter());
+    if (!proof->open(filename, binary)) {
+        proof.reset();
+        return false;
+    }
+    return true;
+}
+
+/// @brief 寫出並關閉 DRAT 證明
+/// @return 證明是否完整寫入
+bool solver::closeProof()
+{
+    return !proof || proof->close();
+}
+
 
-// Solver helper function
-static bool satisfyAlready(const vector<int> &cls)
+/// @brief 子句是否同時含有某個變數的正負文字（恆為真）
+/// @param cls DIMACS 子句
+/// @return 恆為真則回傳 true
+bool solver::satisfyAlready(const vector<int> &cls)
 {
-    unordered_set<int> checker;
-    for (auto &v : cls)
+    // 以 delMarker 記錄出現過的文字正負號，不需為每個子句配置集合
+    delMarker.clear();
+    for (int v : cls)
     {
-        if (checker.find(-v) != checker.end())
-        {
+        int sign = v > 0;
+        int seen = delMarker.get(abs(v));
+        if (seen == (sign ^ 1))
             return true;
-        }
-        checker.insert(v);
+        delMarker.set(abs(v), sign);
     }
     return false;
 }
@@ -79,6 +106,25 @@ static void appendListWatcher(vector<solver::WatcherInfo> &pool, int &head, int
 }
 
 
+/// @brief 從列表中移除指定元素。
+/// @param pool 存放 solver::WatcherInfo 物件的 vector，表示元素的集合。
+/// @param head 指定元素所在列表的頭部。
+/// @param eleid 指定要移除的元素的索引。
+static void removeListWatcher(vector<solver::WatcherInfo> &pool, int &head, int eleid)
+{
+    // 檢查列表的頭部是否是要移除的元素
+    if( eleid == head )
+    {
+        if( pool[head].next == head )
+            head = -1;
+        else
+            head = pool[eleid].next;
+    }
+    pool[pool[eleid].prev].next = pool[eleid].next;
+    pool[pool[eleid].next].prev = pool[eleid].prev;
+}
+
+
 /// @brief 交換 vector 中指定元素的位置，將指定元素從一個列表移動到另一個列表。
 /// @param pool 存放 solver::WatcherInfo 物件的 vector，表示元素的集合。
 /// @param from 指定元素所在的原始列表的頭部。
@@ -86,45 +132,90 @@ static void appendListWatcher(vector<solver::WatcherInfo> &pool, int &head, int
 /// @param eleid 指定要移動的元素的索引。
 static void swapListWatcher(vector<solver::WatcherInfo> &pool, int &from, int &to, int eleid)
 {
-    // 檢查原始列表的頭部是否是要移動的元素
-    if( eleid == from )
-    {
-        if( pool[from].next == from )
-            from = -1;
-        else
-            from = pool[eleid].next;
-    }
     // 從原始列表中移除指定元素
-    pool[pool[eleid].prev].next = pool[eleid].next;
-    pool[pool[eleid].next].prev = pool[eleid].prev;
+    removeListWatcher(pool, from, eleid);
     // 將指定元素新增到目標列表的尾部
     appendListWatcher(pool, to, eleid);
 }
 
 
-// static inline int __idx(int lit) {
-//     return (abs(lit)<<1) + (lit>0);
-// }
-
-
 /// @brief 通過 CNF 檔案進行初始化
 /// @param filename CNF 檔案名稱
 /// @param mode 執行模式
 void solver::init(const char *filename, int mode)
 {
-    // 初始化空的求解器
+    // 從 CNF 檔案中獲取原始子句
+    vector< vector<int> > raw;
+    vector<CardConstraint> rawCards;
+    int maxVar;
+    {
+        TRACE_SCOPE("parse");
+        PerfScope ps(perf, PerfCounters::PARSE);
+        parse_DIMACS_CNF(raw, rawCards, maxVar, filename);
+    }
+    init(raw, rawCards, maxVar, mode);
+}
+
+
+/// @brief 通過已解析的子句進行初始化
+/// @param raw 原始子句（初始化過程中會被修改）
+/// @param rawCards 基數約束
+/// @param maxVar 最大變數索引
+/// @param mode 執行模式
+void solver::init(vector<vector<int>> &raw, vector<CardConstraint> &rawCards, int maxVar, int mode)
+{
+    TRACE_SCOPE("init");
+    // 初始化空的求解器（保留已開啟的證明輸出與驗證設定）
+    unique_ptr<ProofWriter> keepProof = move(proof);
+    bool keepVerify = verify;
+    bool keepCore = trackCore;
+    uint64_t keepSeed = seed;
+    SolverParams keepParams = params;
+    bool keepHuge = hugePages;
+    SolverMetrics *keepMetrics = metrics;
+    PerfCounters *keepPerf = perf;
     *this = solver();
+    proof = move(keepProof);
+    verify = keepVerify;
+    trackCore = keepCore;
+    seed = keepSeed;
+    params = keepParams;
+    hugePages = keepHuge;
+    metrics = keepMetrics;
+    perf = keepPerf;
+    arena.hugePages = hugePages;
+    rng = seed ^ 0x9E3779B97F4A7C15ULL;
+    if (rng == 0)
+        rng = 1;
     runMode = mode;
+    maxVarIndex = maxVar;
+    nextRestart = params.restartUnit;
+    nextVivify = params.vivifyInterval;
+
+    // 保留原始子句以便驗證模型
+    if (verify) {
+        keepOriginal(raw);
+        oriCards = rawCards;
+    }
 
-    // 從 CNF 檔案中獲取原始子句
-    vector< vector<int> > raw;
-    parse_DIMACS_CNF(raw, maxVarIndex, filename);
+    // 追蹤 UNSAT core：第 i 個子句 C 改為 (C ∨ ¬s_i)，求解時假設所有 s_i 為真。
+    // 偵測與刪除子句的預處理會讓子句失去對應的選擇變數，因此不使用
+    if (trackCore)
+    {
+        runMode &= ~(BCE | CCE | GAUSS | CARD);
+        coreVars = maxVarIndex;
+        coreCls = (int)raw.size();
+        for (int i = 0; i < coreCls; ++i)
+            raw[i].push_back(-(coreVars + 1 + i));
+        maxVarIndex += coreCls;
+    }
 
     // 初始化變數堆疊
     var = opStack(maxVarIndex+4);
 
-    // 初始化用於學習子句的容器
-    nowLearnt.resize(maxVarIndex << 1 + 4);
+    // 初始化用於學習子句的容器（學習子句中的文字不會超過變數數量）
+    nowLearnt.reserve(maxVarIndex + 4);
+    minStack.reserve(maxVarIndex + 4);
 
     // 初始化臨時表
     litMarker.init(maxVarIndex+4);
@@ -132,6 +223,17 @@ void solver::init(const char *filename, int mode)
 
     // 初始化啟發式資訊
     varPriQueue.init(maxVarIndex);
+    varPriQueue.decayFactor = params.decay;
+
+    // 從成對編碼的二元子句偵測 at-most-one 約束
+    if ((runMode & CARD) && !proof)
+        detectAtMostOne(raw, rawCards);
+    // 證明無法記錄基數約束的推導
+    if (proof && !rawCards.empty()) {
+        fprintf(stderr, "c cardinality constraints present, DRAT proof disabled\n");
+        proof->close();
+        proof.reset();
+    }
 
     for (auto &cls : raw)
     {
@@ -141,57 +243,77 @@ void solver::init(const char *filename, int mode)
         }
         else if (cls.size() == 1)
         {
-            unit.emplace_back(cls[0]);
+            unit.emplace_back(toLit(cls[0]));
         }
         else if (!satisfyAlready(cls))
         {
-            clauses.push_back(Clause());
-            clauses.back().watcher[0] = 0;
-            clauses.back().watcher[1] = ((int)cls.size() >> 1);
-            clauses.back().simpleCnt[0] = 0;
-            clauses.back().simpleCnt[1] = 0;
-            clauses.back().lit = move(cls);
+            nowLearnt.clear();
+            for (int l : cls)
+                nowLearnt.push_back(toLit(l));
+            int cid = newClause(nowLearnt.data(), (int)nowLearnt.size());
+            clauses[cid].watcher[0] = 0;
+            clauses[cid].watcher[1] = ((int)cls.size() >> 1);
         }
     }
 
     // 初始化兩個觀察者列表和正負文字索引列表
     initAllWatcherList();
 
+    // 加入基數約束
+    nowLevel = 0;
+    for (auto &cd : rawCards)
+        addAtMost(cd.lit, cd.k);
+
     // 為所有單子句進行指派並執行單子句傳播（BCP）
     nowLevel = 0;
     if( unit.size() ) {
         for(auto lit : unit)
-            unsatAfterInit |= !set(abs(lit), lit>0);
+            unsatAfterInit |= !set(lit);
         if(!unsatAfterInit)
             simplifyClause();
     }
 }
 
 
-/// @brief 賦值 id=val@nowLevel 並遞迴地執行 BCP
-/// @param id 要賦值的變數的 ID。
-/// @param val 要賦值的值。
+/// @brief 賦值 lit=true@nowLevel 並遞迴地執行 BCP
+/// @param lit 要設為真的文字。
 /// @param src 指示該賦值的來源。
 /// @return 如果 BCP 成功完成且沒有衝突，則回傳 true；否則回傳 false。
-bool solver::set(int id, bool val, int src) {
+bool solver::set(Lit lit, int src)
+{
+    if( cards.empty() && !gaussActive )
+        return propagate<false>(lit, src);
+    return propagate<true>(lit, src);
+}
+
+
+/// @brief set 的實作；Extra 為 false 時省略基數約束與高斯消去的傳播
+template<bool Extra>
+bool solver::propagate(Lit lit, int src) {
 
     if( solveDone ) return false;
 
-    // 若變數已設定 ID，則檢查一致性
-    if( var.getVal(id) != 2 )
+    // 若文字已被賦值，則檢查一致性
+    int now = var.litVal(lit);
+    if( now != 2 )
     {
         conflictingClsID = -1;
-        return var.getVal(id) == (int)val;
+        return now == 1;
     }
 
     if( nowLevel == 0 ) src = -1;
 
-    // 設定 id=val@nowLevel
-    var.set(id, val, nowLevel, src);
-    
-    // 更新兩文字觀察
+    // 設定 lit=true@nowLevel
+    var.set(lit, nowLevel, src);
+    ++propagations;
+
+    // 基數約束：更新計數，達到上限時其餘文字皆為假
+    if( Extra && !cards.empty() && !propagateCards(lit) )
+        return false;
+
+    // 更新兩文字觀察：只需處理觀察 ~lit 的觀察者
     bool ret = true;
-    int &head = (val ? neg[id] : pos[id]);
+    int &head = watchHead[litNeg(lit)];
     int idx = head;
     while( idx != -1 )
     {
@@ -199,16 +321,13 @@ bool solver::set(int id, bool val, int src) {
         int next = (now.next == head ? -1 : now.next);
 
         // 更新觀察者
-        updateClauseWatcher(now);
-        
-        if (getVal(now) == 2 || eval(now))
+        Lit w = updateClauseWatcher(now);
+
+        if (var.litVal(w) != 0)
         {
             // 情況1：觀察者達到一個待處理/滿足的文字
             // 將該觀察者推入對應的檢查列表
-            if (getSign(now))
-                swapListWatcher(watchers, head, pos[getVar(now)], idx);
-            else
-                swapListWatcher(watchers, head, neg[getVar(now)], idx);
+            swapListWatcher(watchers, head, watchHead[w], idx);
         }
         else
         {
@@ -216,20 +335,20 @@ bool solver::set(int id, bool val, int src) {
             // 無法找到下一個要觀察的文字
 
             // b 是該子句中的另一個觀察者
-            WatcherInfo b(now.clsid, now.wid^1);
+            Lit b = clauses[now.clsid].getWatchLit(now.wid^1);
+            int bval = var.litVal(b);
 
             // 情況2：觀察者的替代觀察者在該子句中
-            if (getVal(b) == 2) 
+            if (bval == 2)
             {
-                //cout<<"c2"<<endl;
-                if( !set(getVar(b), getSign(b), now.clsid) ) {
+                if( !propagate<Extra>(b, now.clsid) ) {
 
                     ret = false;
                     break;
                 }
             }
             // 情況4：觀察者的替代觀察者不滿足該子句
-            else if (!eval(b))
+            else if (bval == 0)
             {
                 conflictingClsID = now.clsid;
                 ret = false;
@@ -239,6 +358,10 @@ bool solver::set(int id, bool val, int src) {
         }
         idx = next;
     }
+    // 子句傳播完成後，由高斯引擎處理新的 XOR 變數賦值
+    if( Extra && ret && gaussActive && !inGauss && gaussHead <= var._top )
+        ret = gaussPropagate();
+
     // BCP 成功完成且沒有衝突
     return ret;
 
@@ -250,9 +373,39 @@ bool solver::set(int id, bool val, int src) {
 void solver::backtrack(int lv)
 {
     // 從變數堆疊中回溯到指定層級之上的變數
-    for (int i=var._top; i >= 0 && var.stk[i].lv > lv; --i)
+    size_t explTop = xorExpl.size();
+    for (int i=var._top; i > var.level[lv]; --i)
     {
-        varPriQueue.restore(var.stk[i].var);
+        Lit lit = var.at(i);
+        int vid = litVar(lit);
+        varPriQueue.restore(vid);
+        phaseRecord[vid] = litSign(lit);
+
+        // 撤銷基數約束的計數（記錄的真文字隨之退出）
+        if( !cards.empty() )
+            for (int c : cardOcc[lit])
+                --cards[c].cnt;
+
+        // 撤銷高斯引擎已處理的賦值，並捨棄 XOR 解釋子句
+        if( gaussActive )
+        {
+            int col = colOfVar[vid];
+            if( col >= 0 && i < gaussHead ) {
+                colAssigned[col >> 6] &= ~(1ULL << (col & 63));
+                colValue[col >> 6] &= ~(1ULL << (col & 63));
+                // 基本變數被撤銷而觀察變數仍保留：此列成為單位列
+                int r = rowOfBasic[col];
+                int c = r >= 0 ? nbWatch[r] : -1;
+                if( c >= 0 && (colAssigned[c >> 6] >> (c & 63) & 1) && var.getLv(varOfCol[c]) <= lv )
+                    gaussRecheck.push_back(r);
+            }
+            if( var.getSrc(vid) == XOR_REASON )
+                explTop = min(explTop, (size_t)xorReasonPos[vid]);
+        }
+    }
+    if( gaussActive ) {
+        gaussHead = min(gaussHead, var.level[lv] + 1);
+        xorExpl.resize(explTop);
     }
     // 回退變數到指定層級
     var.backToLevel(lv);
@@ -265,23 +418,38 @@ void solver::backtrack(int lv)
 // and set vid, sign, src indicating unit variable information.
 
 /// @brief 從衝突中學習
-/// @param vid 參考變數的 ID
-/// @param sign 參考變數的正負號
+/// @param lit 回溯後要賦值的文字
 /// @param src 衝突子句的 ID
 /// @return 學習類型
-int solver::learnFromConflict(int &vid, int &sign, int &src)
+int solver::learnFromConflict(Lit &lit, int &src)
 {
-    vector<int> learnt = firstUIP();
-    if( learnt.empty() )
+    TRACE_SCOPE("conflict");
+    // XOR 衝突不一定包含目前層級的文字：先回溯到衝突實際發生的層級
+    if( conflictingClsID == XOR_CONFLICT )
+    {
+        int maxLv = 0;
+        for (Lit l : xorConflict)
+            maxLv = max(maxLv, var.getLv(litVar(l)));
+        if( maxLv == 0 )
+            return LEARN_UNSAT;
+        if( maxLv < nowLevel ) {
+            backtrack(maxLv);
+            nowLevel = maxLv;
+        }
+    }
+    if( !firstUIP() )
         return LEARN_UNSAT;
+    const vector<Lit> &learnt = nowLearnt;
+    if( proof )
+        proof->add(learnt);
 
     // 確定非時間順序回溯
     int backlv = 0;
     int towatch = -1;
     for (int i = (int)learnt.size()-2; i>=0; --i)
     {
-        if( var.getLv(abs(learnt[i])) > backlv ) {
-            backlv = var.getLv(abs(learnt[i]));
+        if( var.getLv(litVar(learnt[i])) > backlv ) {
+            backlv = var.getLv(litVar(learnt[i]));
             towatch = i;
         }
     }
@@ -290,38 +458,66 @@ int solver::learnFromConflict(int &vid, int &sign, int &src)
     if( learnt.size() == 1 || backlv == 0 ) {
         backtrack(0);
         nowLevel = 0;
-        int uip = learnt.back();
-        if( !set(abs(uip), uip>0) )
+        Lit uip = learnt.back();
+        if( proof && learnt.size() > 1 )
+            proof->add(&uip, 1);
+        if( !set(uip) )
             return LEARN_UNSAT;
         unit.emplace_back(uip);
         return LEARN_ASSIGNMENT;
     }
 
+    // 計算 LBD（學習子句中不同決策層級的數量）
+    int lbd = 0;
+    delMarker.clear();
+    for (Lit l : learnt)
+    {
+        int lv = var.getLv(litVar(l));
+        if( delMarker.get(lv) == -1 ) {
+            delMarker.set(lv, 1);
+            ++lbd;
+        }
+    }
+
     // 新增衝突子句
-    clauses.push_back(Clause());
-    clauses.back().watcher[0] = towatch;           // Latest
-    clauses.back().watcher[1] = (int)learnt.size() - 1; // Learnt
-    clauses.back().lit = move(learnt);
+    int cid = newClause(learnt.data(), (int)learnt.size());
+    clauses[cid].watcher[0] = towatch;           // Latest
+    clauses[cid].watcher[1] = (int)learnt.size() - 1; // Learnt
+    clauses[cid].lbd = lbd;
     watchers.resize(watchers.size()+2);
-    initWatcherList((int)clauses.size() - 1);
+    initWatcherList(cid);
 
     backtrack(backlv);
     nowLevel = backlv;
-    vid = clauses.back().getWatchVar(1);
-    sign = clauses.back().getWatchSign(1);
+    lit = clauses.back().getWatchLit(1);
     src = (int)clauses.size() - 1;
 
     return LEARN_CLAUSE;
 }
 
 
+/// @brief 從配置區建立新的子句（不設定觀察者）
+/// @param lit 子句文字
+/// @param n 文字數量
+/// @return 新子句的 ID
+int solver::newClause(const Lit *lit, int n)
+{
+    clauses.push_back(Clause());
+    Clause &cls = clauses.back();
+    cls.lit = arena.alloc(n);
+    cls.sz = n;
+    copy(lit, lit + n, cls.lit);
+    cls.simpleCnt[0] = cls.simpleCnt[1] = 0;
+    return (int)clauses.size() - 1;
+}
+
+
 /// @brief 初始化所有的觀察者列表。
 void solver::initAllWatcherList()
 {
     // 初始化觀察者列表和正負文字索引列表
     watchers = vector<WatcherInfo>(clauses.size()<<1);
-    pos = vector<int>(maxVarIndex+4, -1);
-    neg = vector<int>(maxVarIndex+4, -1);
+    watchHead = vector<int>((maxVarIndex+4) << 1, -1);
 
     // 遍歷所有子句
     for(int cid=0; cid<clauses.size(); ++cid) {
@@ -338,75 +534,317 @@ void solver::initAllWatcherList()
 void solver::initWatcherList(int cid)
 {
     Clause &cls = clauses[cid];
-    int id = cls.getWatchVar(0);
     int wid1 = (cid<<1);
     int wid2 = (cid<<1) + 1;
 
     // 初始化第一個觀察者
     watchers[wid1] = WatcherInfo(cid, 0);
-    if( cls.getWatchSign(0) )
-        appendListWatcher(watchers, pos[id], wid1);
-    else
-        appendListWatcher(watchers, neg[id], wid1);
+    appendListWatcher(watchers, watchHead[cls.getWatchLit(0)], wid1);
 
     // 初始化第二個觀察者
-    id = cls.getWatchVar(1);
     watchers[wid2] = WatcherInfo(cid, 1);
-    if( cls.getWatchSign(1) )
-        appendListWatcher(watchers, pos[id], wid2);
-    else
-        appendListWatcher(watchers, neg[id], wid2);
+    appendListWatcher(watchers, watchHead[cls.getWatchLit(1)], wid2);
+}
+
+
+/// @brief 將子句的兩個觀察者從觀察者列表中移除。
+/// @param cid 子句的索引。
+void solver::detachClause(int cid)
+{
+    Clause &cls = clauses[cid];
+    for (int wid=0; wid<2; ++wid)
+        removeListWatcher(watchers, watchHead[cls.getWatchLit(wid)], (cid<<1) + wid);
 }
 
 
 bool solver::solve()
 {
     time(&startTime);
-    if( unsatAfterInit ) return sat = false;
+    if( metrics )
+        publishMetrics(SolverMetrics::PREPROCESS);
     // Preprocessing for given problem
     // Init database with all clause which has 2 or more literal in raw database
     // Eliminate all unit clause and check whether there is empty clause
-    if(!preprocess())
-        return sat = false;
-    // Init heuristic
-    initHeuristic();
+    {
+        PerfScope ps(perf, PerfCounters::PREPROCESS);
+        if( unsatAfterInit || !preprocess() || !initGauss() ) {
+            if( proof )
+                proof->add(nullptr, 0);
+            return sat = false;
+        }
+        // Init heuristic
+        initHeuristic();
+        // 從快照接續先前行程的搜尋
+        if( resumeFrom && !restoreSnapshot(*resumeFrom) )
+            return sat = false;
+    }
+    if( metrics )
+        publishMetrics(SolverMetrics::SEARCH);
+    nextCheckpoint = checkpointInterval > 0 ? checkpointInterval : INFINITE;
     sat = _solve();
+    // 超時時寫入最後的快照，之後可以接續搜尋
+    if( checkpointFile && !sat && runTime > timeout )
+        saveSnapshot(checkpointFile);
+    // 不可滿足（而非超時或中斷）時以空子句結束證明
+    if( proof && !sat && runTime <= timeout && !interrupted )
+        proof->add(nullptr, 0);
     return sat;
 }
 
 
+/// @brief 由執行模式與已載入的約束決定搜尋迴圈使用的策略
+int solver::searchPolicy() const
+{
+    int p = 0;
+    if (runMode & RESTART)
+        p |= SP_RESTART;
+    if (runMode & RPHASE)
+        p |= SP_RPHASE;
+    if (runMode & VIVIFY)
+        p |= SP_VIVIFY;
+    if (runMode & (RPHASE|SAMPLE))
+        p |= SP_SAVED_PHASE;
+    if (!cards.empty() || gaussActive)
+        p |= SP_EXTRA;
+    return p;
+}
+
+
+template<size_t... P>
+auto solver::searchTable(index_sequence<P...>)
+{
+    return array<bool (solver::*)(), sizeof...(P)>{ &solver::search<(int)P>... };
+}
+
+
+/// @brief 以符合目前設定的特化版本執行搜尋
 bool solver::_solve()
+{
+    TRACE_SCOPE("search");
+    static const auto table = searchTable(make_index_sequence<SP_COUNT>());
+    return (this->*table[searchPolicy()])();
+}
+
+
+/// @brief 搜尋迴圈；P 為 SearchPolicy 的組合
+template<int P>
+bool solver::search()
 {
     while (true)
     {
+        // 重新啟動，並在重新啟動之間進行 inprocessing
+        bool doRestart = (P & SP_RESTART) && conflicts >= nextRestart;
+        bool doRephase = (P & SP_RPHASE) && conflicts >= nextRephase;
+        // 有 Luby 重新啟動時在到期後的第一次重新啟動進行 vivification；
+        // 沒有時自行回到第 0 層
+        bool doVivify = (P & SP_VIVIFY) && conflicts >= nextVivify;
+        bool ownVivify = doVivify && !(P & SP_RESTART);
+        if (doRestart || doRephase || ownVivify)
+        {
+            PerfScope ps(perf, PerfCounters::INPROCESS);
+            if (doRestart || doRephase)
+                restart();
+            else {
+                backtrack(0);
+                nowLevel = 0;
+            }
+            if (doVivify && !vivifyLearnts())
+                return false;
+            if (doRephase)
+                rephaseLocalSearch();
+        }
+
+        // 收到停止訊號時回到第 0 層寫入快照後結束；定期快照則等搜尋本身回到第 0 層
+        // （重新啟動或學到單一文字）時才寫入，不會改變搜尋路徑
+        if (checkpointFile && (stopRequested || (nowLevel == 0 && runTime >= nextCheckpoint)))
+        {
+            checkpoint();
+            if (interrupted)
+                return false;
+        }
+
+        // 有新的第 0 層賦值時，定期刪除被滿足的子句與為假的文字
+        if (nowLevel == 0 && var._top + 1 > simpTrail && propagations >= nextSimplify) {
+            PerfScope ps(perf, PerfCounters::INPROCESS);
+            simplifyDB();
+        }
+
         ++nowLevel;
-        pii decision = pickUnassignedVar();
-        if( decision.first == -1 )
-            return true;
+        // 假設優先作為決策；有假設為假時在假設下不可滿足
+        Lit lit;
+        int fromAssump = assumps.empty() ? 0 : nextAssumption(lit);
+        if( fromAssump < 0 )
+            return false;
+        if( !fromAssump )
+        {
+            pii decision;
+            {
+                PerfScope ps(perf, PerfCounters::HEAP);
+                decision = pickUnassignedVar<P>();
+            }
+            if( decision.first == -1 )
+                return true;
+            lit = mkLit(decision.first, decision.second);
+        }
         time_t now;
         time(&now);
         runTime = (int)difftime(now, startTime);
         if(runTime>timeout) return false;
-        int vid = decision.first;
-        int sign = decision.second;
-        int src = -1;
-        
-        while (!set(vid, sign, src))
+        if( propagationLimit && propagations >= propagationLimit ) {
+            interrupted = true;
+            return false;
+        }
+        // 每 256 個決策發布一次統計，傳播與衝突分析中不做任何同步
+        if( (++decisions & 255) == 0 && metrics )
+            publishMetrics(SolverMetrics::SEARCH);
+        if( !assignLearn<P>(lit, -1) )
+            return false;
+    }
+    return false;
+}
+
+
+/// @brief 將目前的統計以 relaxed 寫入 metrics，供匯出執行緒讀取
+/// @param phase 目前的階段 (SolverMetrics::Phase)
+void solver::publishMetrics(int phase)
+{
+    SolverMetrics &m = *metrics;
+    m.conflicts.store(conflicts, memory_order_relaxed);
+    m.propagations.store(propagations, memory_order_relaxed);
+    m.decisions.store(decisions, memory_order_relaxed);
+    m.restarts.store(restarts, memory_order_relaxed);
+    m.clauses.store((long long)clauses.size(), memory_order_relaxed);
+    m.learnts.store(max(0LL, (long long)clauses.size() - oriClsNum), memory_order_relaxed);
+    m.trail.store(var._top + 1, memory_order_relaxed);
+    m.level.store(nowLevel, memory_order_relaxed);
+    m.phase.store(phase, memory_order_relaxed);
+}
+
+
+/// @brief 賦值並傳播；發生衝突時學習、回溯並賦值學到的文字，直到沒有衝突為止
+/// @param lit 要設為真的文字
+/// @param src 賦值的來源
+/// @return 若發現問題不可滿足則回傳 false；否則回傳 true
+bool solver::assignLearn(Lit lit, int src)
+{
+    if( cards.empty() && !gaussActive )
+        return assignLearn<0>(lit, src);
+    return assignLearn<SP_EXTRA>(lit, src);
+}
+
+
+template<int P>
+bool solver::assignLearn(Lit lit, int src)
+{
+    while (true)
+    {
+        bool ok;
         {
-            //if( solveDone ) return false;
-            //cout<<conflictingClsID<<endl;
-            if( conflictingClsID == -1 )
-                return false;
+            PerfScope ps(perf, PerfCounters::PROPAGATE);
+            ok = propagate<(P & SP_EXTRA) != 0>(lit, src);
+        }
+        if( ok )
+            break;
+        if( conflictingClsID == -1 )
+            return false;
+        ++conflicts;
 
-            int learnResult = learnFromConflict(vid, sign, src);
-            //cout<<learnResult<<endl;
-            if((learnResult == LEARN_UNSAT))
-                return false;
-            else if( learnResult == LEARN_ASSIGNMENT )
-                break;
+#ifdef SAT_ALLOC_CHECK
+        poolCapacities(capBefore);
+        long long allocBefore = heapAllocCount();
+#endif
+        int learnResult;
+        {
+            // 學到單一文字時的第 0 層傳播也計入這裡
+            PerfScope ps(perf, PerfCounters::ANALYSE);
+            learnResult = learnFromConflict(lit, src);
         }
+#ifdef SAT_ALLOC_CHECK
+        checkConflictAllocs(allocBefore);
+#endif
+        if((learnResult == LEARN_UNSAT))
+            return false;
+        else if( learnResult == LEARN_ASSIGNMENT )
+            break;
     }
-    return false;
+    return true;
+}
+
+
+#ifdef SAT_ALLOC_CHECK
+/// @brief 記錄衝突處理會用到的每個可增長容器的容量
+/// @param cap 輸出的容量，順序固定
+void solver::poolCapacities(vector<size_t> &cap) const
+{
+    cap.clear();
+    cap.insert(cap.end(), {clauses.capacity(), watchers.capacity(), arena.capacity(), arena.chunkSlots(),
+                           unit.capacity(), nowLearnt.capacity(), minStack.capacity(),
+                           xorExpl.capacity(), xorConflict.capacity(), gaussWork.capacity()});
+    for (auto &w : colWatch)
+        cap.push_back(w.capacity());
+}
+
+/// @brief 容器以倍增方式從容量 before 成長到 after 最多需要的配置次數
+static long long growthAllocs(size_t before, size_t after)
+{
+    long long n = 0;
+    if (before == 0) {
+        before = 1;
+        ++n;
+    }
+    for (; before < after; before *= 2)
+        ++n;
+    return n;
+}
+
+/// @brief 檢查一次衝突處理（分析、最小化、新增學習子句、回溯）沒有配置堆積記憶體。
+///        只有容量改變的容器可以配置，且次數不超過倍增成長所需的次數。
+/// @param allocBefore 衝突處理前的配置次數（capBefore 已在此之前記錄）
+void solver::checkConflictAllocs(long long allocBefore)
+{
+    long long allocs = heapAllocCount() - allocBefore;
+    if (allocs == 0)
+        return;
+    poolCapacities(capAfter);
+    long long allowed = 0;
+    for (size_t i = 0; i < capBefore.size() && i < capAfter.size(); ++i)
+        if (capAfter[i] != capBefore[i])
+            allowed += growthAllocs(capBefore[i], capAfter[i]);
+    if (allocs > allowed)
+    {
+        fprintf(stderr, "ERROR! %lld heap allocation(s) during conflict %lld, %lld from pool growth\n",
+                allocs, conflicts, allowed);
+        abort();
+    }
+}
+#endif
+
+
+// Luby 數列的第 i 項 (i 從 1 開始)
+static long long luby(long long i)
+{
+    long long k = 1;
+    while ((1LL << k) - 1 < i)
+        ++k;
+    while ((1LL << k) - 1 != i)
+    {
+        i -= (1LL << (k-1)) - 1;
+        k = 1;
+        while ((1LL << k) - 1 < i)
+            ++k;
+    }
+    return 1LL << (k-1);
+}
+
+
+/// @brief 重新啟動：回溯到第 0 層並排定下一次重新啟動。
+void solver::restart()
+{
+    TRACE_SCOPE("restart");
+    backtrack(0);
+    nowLevel = 0;
+    ++restarts;
+    nextRestart = conflicts + params.restartUnit * luby(restarts);
 }
 
 
@@ -418,10 +856,21 @@ bool solver::_solve()
 /// @return 預處理結果
 bool solver::preprocess() 
 {
+    TRACE_SCOPE("preprocess");
     if (!simplifyClause())
     {
         return false;
     }
+    // 在刪除子句之前從 CNF 中還原 XOR 約束（證明無法記錄高斯消去的推導）
+    if ((runMode & GAUSS) && !proof)
+    {
+        recoverXors();
+    }
+    // 刪除被阻擋的子句（只考慮子句，有基數約束時不適用）
+    if ((runMode & (BCE | CCE)) && cards.empty())
+    {
+        eliminateBlocked();
+    }
     return true;
 }
 
@@ -434,22 +883,26 @@ bool solver::simplifyClause()
     while( cid < clauses.size() ) {
         bool satisfied = false;
         int lid = 0;
+        if( proof )
+            proofTmp.assign(clauses[cid].begin(), clauses[cid].end());
         while( lid < clauses[cid].size() ) {
-            int vid = clauses[cid].getVar(lid);
-            int sign = clauses[cid].getSign(lid);
-            int now = var.getVal(vid);
+            int now = var.litVal(clauses[cid].getLit(lid));
             if( now==2 ) ++lid;
-            else if( now==sign ) {
+            else if( now==1 ) {
                 satisfied = true;
                 break;
             }
             else {
-                swap(clauses[cid].lit[lid], clauses[cid].lit.back());
-                clauses[cid].lit.pop_back();
+                clauses[cid].removeLit(lid);
             }
         }
 
         if( clauses.empty() ) return false;
+        if( proof && (satisfied || clauses[cid].size() != (int)proofTmp.size()) ) {
+            if( !satisfied )
+                proof->add(clauses[cid].lit, clauses[cid].size());
+            proof->del(proofTmp);
+        }
         if( satisfied ) {
             clauses[cid] = clauses.back();
             clauses.pop_back();
@@ -471,8 +924,8 @@ bool solver::simplifyClause()
 ******************************************************/
 
 /// @brief 找到第一個單元子句 (1UIP)。
-/// @return 包含第一個單元子句的變數的向量。如果找不到單元子句，則返回空向量。
-vector<int> solver::firstUIP() 
+/// @return 是否找到；學習子句放在 nowLearnt，1UIP 在最後。
+bool solver::firstUIP() 
 {
     // VSIDS
     if((runMode & VSIDS))
@@ -483,131 +936,124 @@ vector<int> solver::firstUIP()
     // 初始化
     litMarker.clear();
     nowLearnt.clear();
-    int todoNum = _resolve(conflictingClsID, -1);
+    const Lit *confl;
+    int conflN;
+    conflictOf(confl, conflN);
+    int todoNum = _resolve(confl, conflN, -1);
     if (todoNum == -1)
-        return vector<int>();
+        return false;
 
     // 解析和找到 1UIP
     int top = var._top;
     while( todoNum > 1 )
     {
-        while( litMarker.get(var.stk[top].var) == -1)
+        while( litMarker.get(litVar(var.at(top))) == -1)
         {
             --top;
         }
-        int nowNum = _resolve(var.stk[top].src, var.stk[top].var);
+        int x = litVar(var.at(top));
+        const Lit *reason;
+        int n;
+        reasonOf(x, reason, n);
+        int nowNum = _resolve(reason, n, x);
         if( nowNum == -1 )
         {
-            return vector<int>();
+            return false;
         }
         todoNum += nowNum - 1;
         --top;
     }
 
     // 將 1UIP 放在向量的末尾
-    while (litMarker.get(var.stk[top].var) == -1)
+    while (litMarker.get(litVar(var.at(top))) == -1)
     {
         --top;
     }
-    int uip = (var.stk[top].val > 0 ? -var.stk[top].var : var.stk[top].var);
-    nowLearnt.push_back(uip);
+    nowLearnt.push_back(litNeg(var.at(top)));
 
     // 最小化
     minimizeLearntCls();
 
-    return nowLearnt;
+    return true;
 }
 
 
 /// @brief 最小化學習子句。
+///        沿用 firstUIP 在 litMarker 中留下的標記：所有在解析過程中出現過的變數
+///        都已被學習子句蘊含，並將可刪除/不可刪除的結果快取在 litMarker 中。
 void solver::minimizeLearntCls()
 {
-    // 最小化子句
-    litMarker.clear();
-    delMarker.clear();
-
-    // 標記所有學習子句中的文字
-    for(unsigned int i=0; i<nowLearnt.size(); ++i)
-    {
-        litMarker.set(abs(nowLearnt[i]), nowLearnt[i]>0);
-    }
+    Lit uip = nowLearnt.back();
 
-    int eliminateNum = 0;
-
-    // 檢查除了 1UIP 以外的所有文字
+    // 學習子句中（除了 1UIP 以外）所有文字層級的抽象位元遮罩
+    unsigned int abstractLevels = 0;
     for (int i = (int)nowLearnt.size()-2; i>=0; --i)
     {
-        int src = var.getSrc(abs(nowLearnt[i]));
-        if( src == -1 )
-            continue;
-        bool selfSubsumed = true;
-
-        // 檢查該子句中的每個文字
-        for (int j = 0; j < clauses[src].size(); ++j)
-        {
-            int vid = clauses[src].getVar(j);
-            int sign = clauses[src].getSign(j)>0;
-
-            // 如果不是 1UIP 的文字且不是從 1UIP 推導出來的，則該文字無法被子句所取代
-            if( abs(nowLearnt[i])!=vid && !isFromUIP(vid, sign) )
-            {
-                selfSubsumed = false;
-                break;
-            }
-        }
-        // 如果該文字被子句所取代，則將其標記為刪除
-        if( selfSubsumed ) {
-            ++eliminateNum;
-            delMarker.set(i, 1);
-        }
+        abstractLevels |= abstractLevel(litVar(nowLearnt[i]));
     }
 
-    // 如果有文字被刪除，則重新組織學習子句
-    if (eliminateNum)
+    // 檢查除了 1UIP 以外的所有文字，保留無法刪除的文字
+    int j = 0;
+    for (int i = 0; i < (int)nowLearnt.size()-1; ++i)
     {
-        int j = -1;
-        for (unsigned int i=0; i<nowLearnt.size(); ++i)
-        {
-            if( delMarker.get(i) == -1 )
-                nowLearnt[++j] = nowLearnt[i];
-        }
-        nowLearnt.resize(j+1);
+        int vid = litVar(nowLearnt[i]);
+        bool removable = var.getLv(vid) == 0 ||
+            (var.getSrc(vid) != -1 && litRemovable(vid, abstractLevels));
+        if( !removable )
+            nowLearnt[j++] = nowLearnt[i];
     }
+    minimizedLits += (long long)nowLearnt.size() - 1 - j;
+    nowLearnt[j++] = uip;
+    nowLearnt.resize(j);
 }
 
 
-/// @brief 判斷文字是否來自於 1UIP。
-/// @param vid 要判斷的變數的 ID。
-/// @param sign 要判斷的文字的正負號。
-/// @return 如果文字來自於 1UIP，則返回 true；否則返回 false。
-bool solver::isFromUIP(int vid, int sign)
+/// @brief 以明確的堆疊（非遞迴）判斷學習子句中的文字是否能被其他文字蘊含而刪除。
+/// @param vid 要判斷的變數的 ID，必須有來源子句。
+/// @param abstractLevels 學習子句中文字層級的抽象位元遮罩。
+/// @return 如果文字可以刪除，則返回 true；否則返回 false。
+bool solver::litRemovable(int vid, unsigned int abstractLevels)
 {
-    // 如果文字已經被標記，則返回標記結果
-    if( litMarker.get(vid) != -1 )
+    // 堆疊中的每一項為 {變數, 下一個要檢查的來源子句文字位置}
+    minStack.clear();
+    minStack.emplace_back(vid, 0);
+    while( !minStack.empty() )
     {
-        return litMarker.get(vid) == sign;
-    }
+        int x = minStack.back().first;
+        const Lit *reason;
+        int n;
+        reasonOf(x, reason, n);
 
-    int src = var.getSrc(vid);
+        // 來源子句中的文字都已檢查完畢，x 可被刪除
+        if( minStack.back().second == n )
+        {
+            if( minStack.size() > 1 )
+                litMarker.set(x, REMOVABLE);
+            minStack.pop_back();
+            continue;
+        }
 
-    // 如果找不到文字的來源，則標記為不是來自於1UIP
-    if( src == -1 ) {
-        litMarker.set(vid, 2);
-        return false;
-    }
+        int i = minStack.back().second++;
+        int nv = litVar(reason[i]);
+        if( nv == x || var.getLv(nv) == 0 )
+            continue;
 
-    // 遞迴檢查該文字所在的子句中的每個文字
-    for(int i=0; i<clauses[src].size(); ++i) {
-        int nv = clauses[src].getVar(i);
-        int ns = clauses[src].getSign(i);
-        if( nv!=vid && isFromUIP(nv, ns) == false ) {
-            litMarker.set(vid, 2);
+        // 已出現在解析中或已知可刪除
+        int mark = litMarker.get(nv);
+        if( mark == 0 || mark == 1 || mark == REMOVABLE )
+            continue;
+
+        // 決策變數、已知不可刪除，或層級不在學習子句中：無法刪除
+        if( mark == POISONED || var.getSrc(nv) == -1 ||
+            (abstractLevel(nv) & abstractLevels) == 0 )
+        {
+            litMarker.set(nv, POISONED);
+            for (size_t k = 1; k < minStack.size(); ++k)
+                litMarker.set(minStack[k].first, POISONED);
             return false;
         }
+        minStack.emplace_back(nv, 0);
     }
-
-    // 標記文字為來自於1UIP
-    litMarker.set(vid, sign);
     return true;
 }
 
@@ -619,12 +1065,13 @@ bool solver::isFromUIP(int vid, int sign)
 /// @brief 初始化啟發式資訊。
 void solver::initHeuristic()
 {
+    TRACE_SCOPE("initHeuristic");
     // MOM 啟發式搜尋
     if ((runMode & MOM))
     {   // 遍歷所有子句
         for(auto &cls : clauses)
         {   // 若該子句大小 <= 門檻值，則將子句中的每個文字的初始優先級加 1
-            if (cls.size()<=clauseSzThreshold)
+            if (cls.size()<=params.clauseSzThreshold)
             {
                 for (int i=0; i<cls.size(); ++i)
                 {
@@ -632,6 +1079,7 @@ void solver::initHeuristic()
                 }
             }
         }
+        scoreCards(true);
     }
     // JW Score 啟發式搜尋
     else if((runMode & JW))
@@ -643,19 +1091,29 @@ void solver::initHeuristic()
                 varPriQueue.increaseInitPri(cls.getVar(i), pow(0.5, cls.size()), cls.getSign(i));
             }
         }
+        scoreCards(false);
     }
 
     // 隨機選擇
     else
     {
-        srand((unsigned int)time(NULL));
-        double randPri = (double) rand() / (RAND_MAX + 1.0);
-        // 將所有子句中的每個文字的初始優先級設定為隨機值
+        // 將每個變數的初始優先級設定為各自的隨機值
         for (int i=1;i<maxVarIndex+1;i++)
         {
+            double randPri = (nextRand() >> 11) * (1.0 / 9007199254740992.0);
             varPriQueue.increaseInitPri(i, randPri, 1);
         }
     }
+    // 以正負號平衡作為初始相位
+    phaseRecord.assign(maxVarIndex+1, 0);
+    for (int i=1; i<=maxVarIndex; ++i)
+    {
+        phaseRecord[i] = (varPriQueue.litBalance(i) > 0);
+    }
+    // 以位元平行取樣的最佳賦值取代初始相位
+    if (runMode & SAMPLE)
+        samplePhases();
+
     // 建立變數優先級堆積
     varPriQueue.heapify();
 }
@@ -663,6 +1121,7 @@ void solver::initHeuristic()
 
 /// @brief 選擇未分配的變數。
 /// @return 一個包含變數ID和正負號的 pair。如果無法找到未分配的變數，則返回 {-1, 0}。
+template<int P>
 pair<int,int> solver::pickUnassignedVar()
 {
     // 尋找下一個決策變數
@@ -676,7 +1135,7 @@ pair<int,int> solver::pickUnassignedVar()
         varPriQueue.pop();
         if (var.getVal(vid) == 2)
         {
-            int sign = (varPriQueue.litBalance(vid)>0);
+            int sign = (P & SP_SAVED_PHASE) ? phaseRecord[vid] : (varPriQueue.litBalance(vid)>0);
             return {vid, sign};
         }
     }
@@ -702,7 +1161,7 @@ inline bool solver::evalClauesLit(int clsid, int id) const
 /// @return 
 inline bool solver::evalClauesLit(const Clause &cls, int id) const
 {
-    return var.getVal(cls.getVar(id)) == cls.getSign(id);
+    return var.litVal(cls.getLit(id)) == 1;
 }
 
 /// @brief 
@@ -723,12 +1182,12 @@ inline bool solver::evalClauesWatchedLit(const Clause &cls, int wid) const
     return evalClauesLit(cls, cls.watcher[wid]);
 }
 
-inline int solver::updateClauseWatcher(const WatcherInfo &info)
+inline Lit solver::updateClauseWatcher(const WatcherInfo &info)
 {
     return updateClauseWatcher(info.clsid, info.wid);
 }
 
-inline int solver::updateClauseWatcher(int clsid, int wid)
+inline Lit solver::updateClauseWatcher(int clsid, int wid)
 {
     return updateClauseWatcher(clauses[clsid], wid);
 }
@@ -737,13 +1196,12 @@ inline int solver::updateClauseWatcher(int clsid, int wid)
 /// @param cls 子句物件
 /// @param wid 觀察者識別號
 /// @return 
-inline int solver::updateClauseWatcher(Clause &cls, int wid)
+inline Lit solver::updateClauseWatcher(Clause &cls, int wid)
 {
     for (int counter = cls.size(); counter; --counter)
     {
         cls.watchNext(wid);
-        if (!cls.watchSame() &&
-            (var.getVal(cls.getWatchVar(wid)) == 2 || evalClauesWatchedLit(cls, wid)))
+        if (!cls.watchSame() && var.litVal(cls.getWatchLit(wid)) != 0)
         {
             return cls.getWatchLit(wid);
         }
@@ -759,7 +1217,7 @@ inline int solver::updateClauseWatcher(Clause &cls, int wid)
 /// @brief 獲得觀察者的文字值。
 /// @param info 觀察者資訊
 /// @return 回傳觀察者的文字值
-inline int solver::getLit(const WatcherInfo &info) const
+inline Lit solver::getLit(const WatcherInfo &info) const
 {
     return clauses[info.clsid].getWatchLit(info.wid);
 }
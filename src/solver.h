@@ -5,6 +5,16 @@
 #include "clause.h"
 #include "opstack.h"
 #include "heap.h"
+#include "proof.h"
+#include "localsearch.h"
+#include "sampler.h"
+#include "arena.h"
+#include "allochook.h"
+#include "metrics.h"
+#include "trace.h"
+#include "perfcount.h"
+#include "snapshot.h"
+#include "params.h"
 #include <cmath>
 #include <cstdlib>
 #include <vector>
@@ -13,10 +23,16 @@
 #include <iostream>
 #include <ctime>
 #include <chrono>
+#include <memory>
+#include <functional>
+#include <utility>
+#include <array>
+#include <csignal>
 using namespace std;
 
 
 extern int solveDone;
+extern volatile sig_atomic_t stopRequested;   // 收到 SIGTERM/SIGINT：寫入快照後停止搜尋
 
 /// @brief 暫存表
 struct Temptable
@@ -91,27 +107,62 @@ public:
         LEARN_CLAUSE = 3,
         VSIDS = 4,
         MOM = 8,
-        JW = 16
-        // JW = 16,
-        // DFS = 32
+        JW = 16,
+        BCE = 32,
+        CCE = 64,
+        RESTART = 128,
+        VIVIFY = 256,
+        RPHASE = 512,
+        SAMPLE = 1024,
+        GAUSS = 2048,
+        CARD = 4096
+    };
+
+    // 來源為 XOR（高斯消去）或基數約束的賦值與衝突；
+    // 由基數約束 c 推導的賦值，來源為 CARD_REASON - c
+    enum { XOR_REASON = -2, XOR_CONFLICT = -2, CARD_CONFLICT = -3, CARD_REASON = -4 };
+
+    /// @brief 模型重建堆疊中的項目
+    struct ReconEntry
+    {
+        Lit witness;      // 見證文字，子句不滿足時將其設為真
+        vector<Lit> lit;  // 被刪除（或擴充後）的子句
     };
 
     void init(const char *filename, int mode);
+    void init(vector<vector<int>> &raw, vector<CardConstraint> &rawCards, int maxVar, int mode);
+    bool addAtMost(const vector<int> &lits, int k);  // 新增基數約束（需在 init 之後、solve 之前呼叫）
     bool solve();
-    vector<int> result();
+    long long enumerate(const vector<int> &proj, int numVars, long long limit, bool minimize,
+                        const function<bool(const vector<int> &)> &onModel);
+    bool solveAssuming(const vector<int> &assumptions);  // 在假設下求解（可重複呼叫）
+    bool solveCore(bool minimize);                   // 求解，不可滿足時找出 UNSAT core
+    const vector<int> &failed() const;               // 導致不可滿足的假設（DIMACS 文字）
+    const vector<int> &core() const;                 // UNSAT core 中原始子句的索引（從 0 起算）
+    const vector<int> &result();
     void printCNF();
     int size();
 
     int getVarCount();       // 獲取變數數量
     int getClauseCount();    // 獲取子句數量
 
+    bool setProof(const char *filename, bool binary);  // 開啟 DRAT 證明輸出
+    bool closeProof();                                 // 關閉 DRAT 證明輸出，寫入失敗時回傳 false
+
+    long long verifyModel(const vector<int> &model, int threads) const;
+    void placementStats(int node, PlacementStats &st) const;  // 主要資料結構的頁面分布
+    void publishMetrics(int phase);                            // 將目前的統計寫入 metrics
+    void takeSnapshot(SolverSnapshot &s);                      // 回溯到第 0 層並取得求解狀態
+    bool saveSnapshot(const char *filename);                   // 將求解狀態寫入快照檔
+
 protected:
     int unsatAfterInit = 0;       // 初始化後不可滿足的子句數量
     int sat = 1;                  // SAT 結果（0：UNSAT，1：SAT）
     int maxVarIndex;              // 最大變數索引
-    int oriClsNum;                // 初始子句數量
+    int oriClsNum = 0;            // 初始子句數量
     vector<Clause> clauses;       // 子句集合
-    vector<int> unit;             // 單位子句
+    LitArena arena;               // 子句文字的配置區
+    vector<Lit> unit;             // 單位子句
     opStack var;                  // 變數堆疊
     int nowLevel = 0;             // 目前的層級
 
@@ -121,15 +172,38 @@ protected:
     // Helper function for DPLL
     ////////////////////////////////////////////////////////////
 
-    bool set(int var, bool val, int src=-1);
+    bool satisfyAlready(const vector<int> &cls);
+    bool set(Lit lit, int src=-1);
     void backtrack(int lv);
-    int learnFromConflict(int &vid, int &sign, int &src);
+    int learnFromConflict(Lit &lit, int &src);
+    int newClause(const Lit *lit, int n);
     void initAllWatcherList();
     void initWatcherList(int cid);
+    void detachClause(int cid);
 
 
+    // 搜尋迴圈的編譯期策略：由 runMode 與已載入的約束決定，
+    // 每種組合各自實例化，未使用的功能不會在迴圈中留下分支
+    enum SearchPolicy
+    {
+        SP_RESTART = 1,       // Luby 重新啟動
+        SP_RPHASE = 2,        // 與局部搜尋交換相位
+        SP_VIVIFY = 4,        // 重新啟動時 vivification
+        SP_SAVED_PHASE = 8,   // 以儲存的相位作為決策的正負號
+        SP_EXTRA = 16,        // 有基數約束或 XOR 約束需要傳播
+        SP_COUNT = 32
+    };
+    int searchPolicy() const;
+    template<int P> bool search();
+    template<int P> bool assignLearn(Lit lit, int src);
+    template<bool Extra> bool propagate(Lit lit, int src);
+    template<size_t... P> static auto searchTable(index_sequence<P...>);
+
     bool _solve();
-    inline int _resolve(int clsid, int x);
+    bool assignLearn(Lit lit, int src);
+    inline int _resolve(const Lit *lit, int n, int x);
+    inline void reasonOf(int vid, const Lit *&lit, int &n);
+    inline void conflictOf(const Lit *&lit, int &n);
 
     ////////////////////////////////////////////////////////////
     // Preprocess
@@ -138,6 +212,139 @@ protected:
     bool preprocess();
     bool simplifyClause();
 
+    // Blocked / Covered Clause Elimination
+    vector<vector<int>> occurs;     // 文字出現列表（以文字索引）
+    vector<char> eliminated;        // 子句是否已被刪除
+    vector<ReconEntry> reconStack;  // 模型重建堆疊
+    Temptable coverCnt;             // CCE 交集計數（以文字索引）
+    long long elimSteps = 0;        // 已使用的步數
+
+    void eliminateBlocked();
+    Lit findBlockingLit(int cid);
+    Lit coverClause(int cid, vector<Lit> &cover, vector<ReconEntry> &steps);
+    void extendModel(vector<int> &model) const;
+
+    ////////////////////////////////////////////////////////////
+    // Restart and Inprocessing
+    ////////////////////////////////////////////////////////////
+
+    long long nextRestart = 0;      // 下一次重新啟動的衝突數
+    long long nextVivify = 0;       // 下一次 vivification 的衝突數
+    long long lastVivifyProps = 0;  // 上一次 vivification 時的傳播數
+    vector<int> vivifyCand;         // vivification 候選子句
+    vector<Lit> vivifyKept;         // vivification 保留的文字
+
+    void restart();
+    bool vivifyLearnts();
+    int vivifyClause(int cid);
+
+    // 第 0 層的子句資料庫簡化
+    int simpTrail = 0;              // 上一次簡化時第 0 層的賦值數
+    long long nextSimplify = 0;     // 下一次簡化的傳播數
+    void simplifyDB();
+    void moveClause(int from, int to);
+
+    // XOR 約束與高斯消去
+    int xorCols = 0;                // 矩陣的行數（出現在 XOR 中的變數數量）
+    int xorWords = 0;               // 每列的 64 位元字組數
+    vector<int> colOfVar;           // 變數對應的行（-1 表示不在 XOR 中）
+    vector<int> varOfCol;           // 行對應的變數
+    vector<uint64_t> xorMat;        // 係數矩陣，每列 xorWords 個字組
+    vector<char> xorRhs;            // 每列的右側常數
+    vector<int> basicOf;            // 每列的基本變數（行）
+    vector<int> rowOfBasic;         // 以該行為基本變數的列（-1 表示非基本）
+    vector<int> nbWatch;            // 每列觀察的非基本變數（行）
+    vector<vector<int>> colWatch;   // 觀察該行的列
+    vector<uint64_t> colAssigned;   // 高斯引擎已處理的賦值（位元集合）
+    vector<uint64_t> colValue;      // 已處理賦值的值（位元集合）
+    vector<uint64_t> colBasic;      // 基本變數（位元集合）
+    vector<int> gaussWork;          // 待修正的列
+    vector<int> gaussRecheck;       // 回溯後需重新檢查的列（基本變數被撤銷）
+    int gaussHead = 0;              // 下一個要處理的軌跡位置
+    int gaussCol = -1;              // 目前處理的行
+    bool gaussActive = false;
+    bool inGauss = false;
+    bool gaussConflict = false;
+    vector<Lit> xorExpl;            // XOR 賦值的解釋子句（[長度, 文字...]）
+    vector<int> xorReasonPos;       // 變數的解釋子句在 xorExpl 中的位置
+    vector<Lit> xorConflict;        // XOR 衝突子句
+
+    vector<vector<int>> xorCand;    // 從 CNF 還原的 XOR 約束（變數已排序）
+    vector<char> xorCandRhs;        // XOR 約束的右側常數
+    void (*rowXor)(uint64_t *dst, const uint64_t *src, int words) = nullptr;
+
+    void recoverXors();
+    bool initGauss();
+    bool gaussPropagate();
+    bool gaussAssign(int col);
+    bool fixRow(int r);
+    void pivotRow(int r, int col);
+    void setRowWatch(int r, int col);
+    bool gaussImply(int r);
+    void rowExplain(int r, int skipCol, vector<Lit> &out);
+    inline uint64_t *rowPtr(int r) { return &xorMat[(size_t)r * xorWords]; }
+    inline const uint64_t *rowPtr(int r) const { return &xorMat[(size_t)r * xorWords]; }
+
+    // 基數約束 (at-most-k)，以計數器取代觀察者
+    struct CardInfo
+    {
+        int lit;        // 文字在 cardLits 中的起始位置
+        int n;          // 文字數量
+        int k;          // 上限
+        int cnt;        // 目前為真的文字數量
+        int tru;        // 真文字在 cardTrue 中的起始位置
+    };
+    vector<CardInfo> cards;
+    vector<Lit> cardLits;           // 所有基數約束的文字
+    vector<Lit> cardTrue;           // 每個約束依賦值順序記錄的前 k+1 個真文字
+    vector<vector<int>> cardOcc;    // 含有該文字的基數約束（以文字索引）
+    vector<Lit> cardExpl;           // 分析衝突時才產生的解釋子句
+    int cardConflict = -1;          // 發生衝突的基數約束
+
+    bool propagateCards(Lit lit);
+    void cardExplain(int c, int vid);
+    void scoreCards(bool mom);
+    void detectAtMostOne(vector<vector<int>> &raw, vector<CardConstraint> &found);
+
+    // 列舉所有解
+    vector<int> projIndex;          // 變數在投影集合中的位置（-1 表示不在其中）
+    vector<Lit> blockLits;          // 所有阻擋子句（以文字 0 結尾串接）
+    vector<int> minTrue;            // 模型最小化：每個子句中固定為真的文字數
+    vector<int> minOccStart;        // 模型最小化：投影變數的真文字出現列表（CSR）
+    vector<int> minOcc;
+
+    bool addBlockingClause(vector<Lit> &block);
+    void minimizeModel(const vector<int> &proj, vector<Lit> &cube);
+
+    // 假設與 UNSAT core：假設依序作為最前面的決策
+    bool searchReady = false;       // 是否已完成預處理與啟發式初始化
+    vector<Lit> assumps;            // 目前的假設
+    vector<int> assumpAt;           // 每個決策層級之後下一個要檢查的假設位置
+    vector<Lit> failedAssumps;      // 導致不可滿足的假設子集
+    vector<int> failedDimacs;
+    int coreVars = 0;               // 加上選擇變數之前的變數數量
+    int coreCls = 0;                // 原始子句數量（即選擇變數數量）
+    vector<int> coreIdx;            // UNSAT core 中原始子句的索引
+
+    bool searchAssuming();
+    int nextAssumption(Lit &lit);
+    void analyzeFinal(Lit p);
+    bool fixSelector(Lit lit);
+
+    // 與局部搜尋交換相位 (rephasing)
+    long long nextRephase = 0;      // 下一次交換相位的衝突數
+    LocalSearch localSearch;
+    void rephaseLocalSearch();
+
+    // 快照與續跑
+    int nextCheckpoint = INFINITE;  // 下一次定期寫入快照的執行時間（秒）
+    bool interrupted = false;       // 因停止訊號或傳播數上限而結束搜尋（結果為未知）
+    bool restoreSnapshot(const SolverSnapshot &s);
+    void checkpoint();
+
+    // 位元平行取樣初始相位
+    void samplePhases();
+
     ////////////////////////////////////////////////////////////
     // Clause helper function
     ////////////////////////////////////////////////////////////
@@ -147,75 +354,204 @@ protected:
     inline bool evalClauesWatchedLit(const WatcherInfo &info) const;
     inline bool evalClauesWatchedLit(int clsid, int wid) const;
     inline bool evalClauesWatchedLit(const Clause &cls, int wid) const;
-    inline int updateClauseWatcher(const WatcherInfo &info);
-    inline int updateClauseWatcher(int clsid, int wid);
-    inline int updateClauseWatcher(Clause &cls, int wid);
+    inline Lit updateClauseWatcher(const WatcherInfo &info);
+    inline Lit updateClauseWatcher(int clsid, int wid);
+    inline Lit updateClauseWatcher(Clause &cls, int wid);
 
     ////////////////////////////////////////////////////////////
     // 2 Literal Watching helper function
     ////////////////////////////////////////////////////////////
 
-    inline int getLit(const WatcherInfo &info) const;
+    inline Lit getLit(const WatcherInfo &info) const;
     inline int getVar(const WatcherInfo &info) const;
     inline int getSign(const WatcherInfo &info) const;
     inline int getVal(const WatcherInfo &info) const;
     inline bool eval(const WatcherInfo &info) const;
 
     // Conflict Clause Learning Heuristic
-    vector<int> nowLearnt;
+    vector<Lit> nowLearnt;
 
-    vector<int> firstUIP();
+    bool firstUIP();
     void minimizeLearntCls();
-    bool isFromUIP(int vid, int sign);
+    bool litRemovable(int vid, unsigned int abstractLevels);
+    inline unsigned int abstractLevel(int vid) const;
+
+    // litMarker 中除了文字正負號 (0/1) 以外的最小化狀態
+    enum { POISONED = 2, REMOVABLE = 3 };
+    vector<pii> minStack;           // 最小化使用的明確堆疊
 
 
 
     void initHeuristic();
-    pii pickUnassignedVar();
+    template<int P> pii pickUnassignedVar();
     // int pickBalancedPhase(int vid);
 
 public:
-    static const int  clauseSzThreshold = 10;
+    static const int  elimStepLimit = 20000000;  // BCE/CCE 的步數預算
+    static const int  coverSzLimit = 64;         // CCE 擴充子句的大小上限
+    static const int  maxXorSize = 6;            // 從 CNF 還原的 XOR 約束的變數數上限
+    static const int  cardDetectMin = 4;         // 從 CNF 偵測的 at-most-one 約束的文字數下限
+    static const int  cardDetectSteps = 10000000;  // 偵測 at-most-one 約束的步數預算
     int               runMode;      // 執行模式
     int               timeout;      // 超時時間
     time_t            startTime;    // 開始時間
-    int               runTime;      // 執行時間
+    int               runTime = 0;  // 執行時間
+    bool              verify = false;  // 是否保留原始子句以驗證模型（需在 init 前設定）
+    bool              trackCore = false;  // 是否為每個原始子句加上選擇變數以找出 UNSAT core（需在 init 前設定）
+    uint64_t          seed = 1;     // 亂數種子，相同的種子與輸入得到相同的搜尋過程（需在 init 前設定）
+    SolverParams      params;       // 可調整的求解參數（需在 init 前設定）
+    long long         propagationLimit = 0;  // 傳播數達到此值時以未知結束（0 表示不限，需在 init 後設定）
+    bool              hugePages = false;  // 以透明大頁配置子句文字（需在 init 前設定）
+    SolverMetrics    *metrics = nullptr;  // 搜尋時定期發布統計資訊的目的地（需在 init 前設定）
+    PerfCounters     *perf = nullptr;     // 各階段的硬體計數器（需在 init 前設定）
+    const char       *checkpointFile = nullptr;  // 定期、超時與收到停止訊號時寫入的快照（需在 init 後設定）
+    int               checkpointInterval = 0;    // 定期寫入快照的間隔（秒，0 表示只在停止時寫入）
+    uint64_t          formulaHash = 0;           // 輸入的 snapshotFormulaHash，記錄在快照中（需在 init 後設定）
+    const SolverSnapshot *resumeFrom = nullptr;  // 預處理後從此快照接續搜尋（需在 init 後設定）
+
+    // 統計資訊
+    long long         conflicts = 0;      // 衝突次數
+    long long         decisions = 0;      // 決策次數
+    long long         propagations = 0;   // 傳播次數
+    long long         restarts = 0;       // 重新啟動次數
+    long long         vivifiedLits = 0;   // vivification 刪除的文字數
+    long long         minimizedLits = 0;  // 學習子句最小化刪除的文字數
+    long long         rephases = 0;       // 與局部搜尋交換相位的次數
+    int               lsBestUnsat = -1;   // 最近一次局部搜尋的最少不滿足子句數
+    long long         sampled = 0;        // 位元平行取樣評估的賦值數
+    int               sampleBestUnsat = -1;  // 取樣得到的最少不滿足子句數
+    long long         simplifies = 0;     // 第 0 層簡化的次數
+    long long         simpRemovedCls = 0;    // 簡化刪除的子句數
+    long long         simpRemovedLits = 0;   // 簡化刪除的文字數
+    int               xorsFound = 0;      // 從 CNF 還原的 XOR 約束數
+    long long         gaussProps = 0;     // 高斯消去推導的賦值數
+    long long         gaussConflicts = 0; // 高斯消去發現的衝突數
+    int               cardsDetected = 0;  // 從 CNF 偵測的 at-most-one 約束數
+    long long         cardRemovedCls = 0; // 被偵測的約束取代的二元子句數
+    long long         cardProps = 0;      // 基數約束推導的賦值數
+    long long         cardConflicts = 0;  // 基數約束發現的衝突數
+    long double       projCount = 0;      // 列舉得到的（投影後）模型數
+    bool              enumComplete = false;  // 是否已列舉完所有解（未超時或中止）
+    int               coreCalls = 0;      // 找 UNSAT core 時的求解次數
+    bool              coreMinimal = false;   // UNSAT core 是否已最小化（刪除任一子句皆可滿足）
+    int               checkpoints = 0;    // 寫入快照的次數
+    long long         elapsedBefore = 0;  // 先前的行程已使用的搜尋時間（秒，從快照還原）
 
 protected:
+    vector<int> model;              // result() 回傳的模型
+    uint64_t rng = 1;               // 亂數狀態（由 seed 初始化）
+    inline uint64_t nextRand();
+
+#ifdef SAT_ALLOC_CHECK
+    vector<size_t> capBefore, capAfter;     // 衝突處理前後各容器的容量
+    void poolCapacities(vector<size_t> &cap) const;
+    void checkConflictAllocs(long long allocBefore);
+#endif
+
+    // 原始子句（以 0 結尾串接）與基數約束，僅在 verify 時保留
+    vector<int> oriLits;
+    vector<CardConstraint> oriCards;
+    void keepOriginal(const vector<vector<int>> &raw);
+
+    // DRAT 證明（未開啟時為空）
+    unique_ptr<ProofWriter> proof;
+    vector<Lit> proofTmp;
+
     int conflictingClsID = -1;
     Temptable litMarker;
     Temptable delMarker;
 
     // 2 Literal Watching
     vector<WatcherInfo> watchers;   // 觀察者集合
-    vector<int> pos;
-    vector<int> neg;
+    vector<int> watchHead;          // 觀察該文字的觀察者列表（以文字索引）
 
     // Branching Heuristic
     VarHeap varPriQueue;
-    vector<int> phaseRecord;
+    vector<int> phaseRecord;        // 儲存的相位（回溯時記錄，rephasing 時覆寫）
 };
 
 
 
 
 
+/// @brief 變數所在決策層級的抽象位元
+/// @param vid 變數的 ID
+/// @return 以層級對 32 取餘數決定的位元
+inline unsigned int solver::abstractLevel(int vid) const
+{
+    return 1u << (var.getLv(vid) & 31);
+}
+
+
+/// @brief 取得變數的來源子句（一般子句、XOR 或基數約束的解釋子句）；
+///        基數約束的解釋子句暫存在 cardExpl，下次呼叫時會被覆寫
+/// @param vid 變數的 ID，必須有來源
+/// @param lit 來源子句的文字
+/// @param n 文字數量
+inline void solver::reasonOf(int vid, const Lit *&lit, int &n)
+{
+    int src = var.getSrc(vid);
+    if (src <= CARD_REASON)
+    {
+        cardExplain(CARD_REASON - src, vid);
+        n = (int)cardExpl.size();
+        lit = cardExpl.data();
+    }
+    else if (src == XOR_REASON)
+    {
+        int pos = xorReasonPos[vid];
+        n = (int)xorExpl[pos];
+        lit = &xorExpl[pos + 1];
+    }
+    else
+    {
+        n = clauses[src].size();
+        lit = clauses[src].lit;
+    }
+}
+
+
+/// @brief 取得衝突子句（一般子句、XOR 或基數約束的衝突）
+/// @param lit 衝突子句的文字
+/// @param n 文字數量
+inline void solver::conflictOf(const Lit *&lit, int &n)
+{
+    if (conflictingClsID == CARD_CONFLICT)
+    {
+        cardExplain(cardConflict, 0);
+        n = (int)cardExpl.size();
+        lit = cardExpl.data();
+    }
+    else if (conflictingClsID == XOR_CONFLICT)
+    {
+        n = (int)xorConflict.size();
+        lit = xorConflict.data();
+    }
+    else
+    {
+        n = clauses[conflictingClsID].size();
+        lit = clauses[conflictingClsID].lit;
+    }
+}
+
+
 /// @brief 解析衝突子句以獲取解析數量 (Resolve helper)
-/// @param clsid 衝突子句的 ID
+/// @param cls 衝突子句（或來源子句）的文字
+/// @param n 文字數量
 /// @param x 排除的變數 ID
 /// @return 解析的數量
-inline int solver::_resolve(int clsid, int x)
+inline int solver::_resolve(const Lit *cls, int n, int x)
 {
     int ret = 0;
-    for (int i=0; i<clauses[clsid].size(); ++i)
+    for (int i=0; i<n; ++i)
     {
-        int lit = clauses[clsid].getLit(i);
-        int vid = clauses[clsid].getVar(i);
-        int sign = clauses[clsid].getSign(i);
+        Lit lit = cls[i];
+        int vid = litVar(lit);
+        int sign = litSign(lit);
         if( vid == x || litMarker.get(vid) == sign ) continue;
         if( litMarker.get(vid) != -1 ) return -1;
         litMarker.set(vid, sign);
-        varPriQueue.increasePri(vid, 1.0-VarHeap::decayFactor, sign);
+        varPriQueue.increasePri(vid, 1.0-varPriQueue.decayFactor, sign);
         if (var.getLv(vid) == nowLevel)
         {
             ++ret;
@@ -229,4 +565,15 @@ inline int solver::_resolve(int clsid, int x)
 }
 
 
+
+/// @brief xorshift64* 亂數
+inline uint64_t solver::nextRand()
+{
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return rng * 0x2545F4914F6CDD1DULL;
+}
+
+
 #endif
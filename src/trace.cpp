@@ -0,0 +1,117 @@
+#include "trace.h"
+
+#ifdef SAT_TRACE
+#include <cstdio>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+
+atomic<bool> traceEnabled{false};
+
+namespace {
+
+// 一個事件：開始時間與結束時間（奈秒，從 traceStart 起算再加 1，0 保留給未啟用）
+struct TraceEvent
+{
+    const char *name;
+    uint64_t begin;
+    uint64_t end;
+};
+
+// 一個執行緒的環狀緩衝區；寫滿之後覆寫最舊的事件
+struct TraceBuffer
+{
+    static constexpr size_t capacity = (size_t)1 << 18;
+
+    vector<TraceEvent> ev;
+    atomic<size_t> head{0};     // 已寫入的事件總數
+    int tid;
+
+    explicit TraceBuffer(int t) : ev(capacity), tid(t) {}
+};
+
+mutex registryLock;
+vector<unique_ptr<TraceBuffer>> registry;   // 所有執行緒的緩衝區，存活到行程結束
+chrono::steady_clock::time_point epoch;
+
+// 第一次記錄時才建立並登記目前執行緒的緩衝區（只有這裡需要鎖）
+TraceBuffer &localBuffer()
+{
+    thread_local TraceBuffer *buf = nullptr;
+    if (buf == nullptr)
+    {
+        lock_guard<mutex> lk(registryLock);
+        registry.emplace_back(new TraceBuffer((int)registry.size() + 1));
+        buf = registry.back().get();
+    }
+    return *buf;
+}
+
+}  // namespace
+
+
+/// @brief 開始追蹤；之後進入的 TRACE_SCOPE 才會被記錄
+void traceStart()
+{
+    epoch = chrono::steady_clock::now();
+    traceEnabled = true;
+}
+
+
+uint64_t traceNow()
+{
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - epoch).count() + 1;
+}
+
+
+/// @brief 記錄一個事件到目前執行緒的緩衝區
+void traceRecord(const char *name, uint64_t begin, uint64_t end)
+{
+    TraceBuffer &buf = localBuffer();
+    size_t h = buf.head.load(memory_order_relaxed);
+    buf.ev[h & (TraceBuffer::capacity - 1)] = {name, begin, end};
+    buf.head.store(h + 1, memory_order_release);
+}
+
+
+/// @brief 以 Chrome trace JSON 格式輸出所有執行緒的事件（需在其他執行緒停止記錄後呼叫）
+/// @param filename 輸出檔名
+/// @return 是否成功
+bool traceDump(const char *filename)
+{
+    traceEnabled = false;
+    FILE *out = fopen(filename, "w");
+    if (out == NULL) {
+        fprintf(stderr, "ERROR! Could not open trace file: %s\n", filename);
+        return false;
+    }
+
+    lock_guard<mutex> lk(registryLock);
+    long long dropped = 0;
+    bool first = true;
+    fputs("{\"traceEvents\":[\n", out);
+    for (auto &buf : registry)
+    {
+        size_t head = buf->head.load(memory_order_acquire);
+        size_t n = min(head, TraceBuffer::capacity);
+        dropped += (long long)(head - n);
+        fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+                first ? "" : ",\n", buf->tid, buf->tid);
+        first = false;
+        for (size_t i = head - n; i < head; ++i)
+        {
+            const TraceEvent &e = buf->ev[i & (TraceBuffer::capacity - 1)];
+            fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    e.name, buf->tid, (e.begin - 1) / 1000.0, (e.end - e.begin) / 1000.0);
+        }
+    }
+    fprintf(out, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":%lld}}\n", dropped);
+    return fclose(out) == 0;
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef __TRACE_H
+#define __TRACE_H
+
+// 以 SAT_TRACE 建置時（cmake -DSAT_TRACE=ON），TRACE_SCOPE 會在區塊結束時記錄一個
+// 帶有開始時間與長度的事件到目前執行緒的環狀緩衝區（只有該執行緒寫入，不需要鎖），
+// 執行結束時以 Chrome trace JSON 輸出，可載入 chrome://tracing 或 Perfetto 檢視。
+// 未以 SAT_TRACE 建置時 TRACE_SCOPE 不產生任何程式碼。
+#ifdef SAT_TRACE
+#include <cstdint>
+#include <atomic>
+
+extern std::atomic<bool> traceEnabled;
+
+void traceStart();
+bool traceDump(const char *filename);
+uint64_t traceNow();
+void traceRecord(const char *name, uint64_t begin, uint64_t end);
+
+// 記錄一個區塊的執行時間；name 必須是字串常值
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *n)
+        : name(n), begin(traceEnabled.load(std::memory_order_relaxed) ? traceNow() : 0) {}
+    ~TraceScope()
+    {
+        if (begin)
+            traceRecord(name, begin, traceNow());
+    }
+
+private:
+    const char *name;
+    uint64_t begin;         // 0 表示未啟用追蹤
+};
+
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#endif
+
+#endif
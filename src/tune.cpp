@@ -0,0 +1,245 @@
+#include "tune.h"
+#include "solver.h"
+#include <cstdio>
+#include <cmath>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <functional>
+#include <filesystem>
+namespace fs = std::filesystem;
+
+
+namespace {
+
+struct Instance
+{
+    string name;
+    vector<vector<int>> raw;
+    vector<CardConstraint> cards;
+    int maxVar = 0;
+};
+
+// 一次求解的結果；解出的結果在之後較大的上限下不會改變，可以直接沿用
+struct Outcome
+{
+    bool solved = false;
+    long long work = 0;         // 傳播數
+};
+
+uint64_t nextRand(uint64_t &s)
+{
+    s ^= s >> 12;
+    s ^= s << 25;
+    s ^= s >> 27;
+    return s * 0x2545F4914F6CDD1DULL;
+}
+
+double uniform(uint64_t &s)
+{
+    return (nextRand(s) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+// 在調校範圍內取樣一組設定；不作用於目前執行模式的參數保留基準值
+SolverParams sampleParams(const SolverParams &base, int mode, uint64_t &rng)
+{
+    SolverParams p = base;
+    for (int i = 0; i < paramCount; ++i)
+    {
+        const ParamInfo &info = paramTable[i];
+        if (info.lo == info.hi || !(mode & info.modeMask))
+            continue;
+        double u = uniform(rng);
+        double v = info.logScale ? exp(log(info.lo) + u * (log(info.hi) - log(info.lo)))
+                                 : info.lo + u * (info.hi - info.lo);
+        if (info.real)
+            p.*info.real = v;
+        else
+            p.*info.integer = (int)lround(v);
+    }
+    return p;
+}
+
+
+bool hasTunable(int mode)
+{
+    for (int i = 0; i < paramCount; ++i)
+        if (paramTable[i].lo != paramTable[i].hi && (mode & paramTable[i].modeMask))
+            return true;
+    return false;
+}
+
+
+Outcome solveOnce(const Instance &inst, const SolverParams &p, const TuneConfig &cfg, long long budget)
+{
+    vector<vector<int>> raw = inst.raw;
+    vector<CardConstraint> cards = inst.cards;
+    solver s;
+    s.seed = cfg.seed;
+    s.params = p;
+    s.init(raw, cards, inst.maxVar, cfg.mode);
+    s.timeout = solver::INFINITE;
+    s.propagationLimit = budget;
+    s.solve();
+    Outcome o;
+    o.solved = s.result()[0] != -1;
+    o.work = s.propagations;
+    return o;
+}
+
+
+// 以 workers 個執行緒執行 f(0..n-1)
+void parallelFor(int n, int workers, const function<void(int)> &f)
+{
+    atomic<int> next{0};
+    auto body = [&]() {
+        for (int i; (i = next.fetch_add(1)) < n; )
+            f(i);
+    };
+    vector<thread> pool;
+    for (int t = 1; t < min(workers, n); ++t)
+        pool.emplace_back(body);
+    body();
+    for (auto &th : pool)
+        th.join();
+}
+
+
+string describe(const SolverParams &p, const SolverParams &base)
+{
+    string s;
+    for (int i = 0; i < paramCount; ++i)
+    {
+        string v = paramValue(p, paramTable[i]);
+        if (v != paramValue(base, paramTable[i]))
+            s += string(s.empty() ? "" : " ") + paramTable[i].name + "=" + v;
+    }
+    return s.empty() ? "defaults" : s;
+}
+
+}  // namespace
+
+
+/// @brief 為目錄中的每個類別調校參數並寫出設定檔
+/// @param cfg 調校設定
+/// @return 結束碼
+int runTune(const TuneConfig &cfg)
+{
+    error_code ec;
+    vector<fs::path> classDirs;
+    for (auto &entry : fs::directory_iterator(cfg.dir, ec))
+        if (entry.is_directory())
+            classDirs.push_back(entry.path());
+    if (ec) {
+        fprintf(stderr, "ERROR! Could not read benchmark directory: %s\n", cfg.dir);
+        return 1;
+    }
+    sort(classDirs.begin(), classDirs.end());
+
+    int workers = cfg.workers > 0 ? cfg.workers : max(1, (int)thread::hardware_concurrency());
+    int configs = hasTunable(cfg.mode) ? max(cfg.configs, 1) : 1;
+    if (configs == 1)
+        printf("c tune: mode %d has no tunable parameters, keeping the base configuration\n", cfg.mode);
+
+    vector<pair<string, SolverParams>> best;
+    string summary;
+    for (auto &dir : classDirs)
+    {
+        string className = dir.filename().string();
+        vector<fs::path> files;
+        for (auto &entry : fs::directory_iterator(dir))
+            if (entry.is_regular_file() && entry.path().extension() == ".cnf")
+                files.push_back(entry.path());
+        if (files.empty())
+            continue;
+        sort(files.begin(), files.end());
+
+        // 每個測資只解析一次，之後每次求解複製一份
+        vector<Instance> insts(files.size());
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+            insts[i].name = files[i].filename().string();
+            parse_DIMACS_CNF(insts[i].raw, insts[i].cards, insts[i].maxVar, files[i].string().c_str());
+        }
+
+        // 候選設定：基準設定加上隨機取樣，種子由全域種子與類別名稱決定
+        uint64_t rng = cfg.seed ^ 0x9E3779B97F4A7C15ULL;
+        for (char ch : className)
+            rng = (rng ^ (unsigned char)ch) * 0x100000001B3ULL;
+        if (rng == 0)
+            rng = 1;
+        vector<SolverParams> cand(1, cfg.base);
+        while ((int)cand.size() < configs)
+            cand.push_back(sampleParams(cfg.base, cfg.mode, rng));
+
+        size_t n = insts.size();
+        vector<vector<Outcome>> res(cand.size(), vector<Outcome>(n));
+        vector<int> alive(cand.size());
+        for (size_t c = 0; c < cand.size(); ++c)
+            alive[c] = (int)c;
+        vector<long long> score(cand.size(), 0);
+        long long budget = max(cfg.budget, 1LL);
+
+        for (int round = 1; ; ++round)
+        {
+            // 基準設定即使被淘汰也繼續求解，作為比較的基準
+            vector<int> run = alive;
+            if (find(run.begin(), run.end(), 0) == run.end())
+                run.push_back(0);
+            vector<pair<int, int>> jobs;
+            for (int c : run)
+                for (size_t i = 0; i < n; ++i)
+                    if (!res[c][i].solved)
+                        jobs.emplace_back(c, (int)i);
+            parallelFor((int)jobs.size(), workers, [&](int j) {
+                int c = jobs[j].first, i = jobs[j].second;
+                res[c][i] = solveOnce(insts[i], cand[c], cfg, budget);
+            });
+
+            int solvedBest = 0;
+            for (int c : run)
+            {
+                score[c] = 0;
+                for (size_t i = 0; i < n; ++i)
+                    score[c] += res[c][i].solved ? res[c][i].work : 2 * budget;
+            }
+            // 分數相同時保留編號較小者，基準設定優先
+            sort(alive.begin(), alive.end(), [&](int a, int b) {
+                return score[a] < score[b] || (score[a] == score[b] && a < b);
+            });
+            for (size_t i = 0; i < n; ++i)
+                solvedBest += res[alive[0]][i].solved;
+            printf("c tune %s round %d: %zu configs x %zu instances, budget %lld, "
+                   "best #%d score %lld (%d solved), base score %lld\n",
+                   className.c_str(), round, alive.size(), n, budget,
+                   alive[0], score[alive[0]], solvedBest, score[0]);
+            fflush(stdout);
+            if (alive.size() <= 2)
+                break;
+            alive.resize((alive.size() + 1) / 2);
+            budget *= 2;
+        }
+
+        int win = alive[0];
+        printf("c tune %s: %s\n", className.c_str(), describe(cand[win], cfg.base).c_str());
+        best.emplace_back(className, cand[win]);
+        summary += "\n" + className + ": score " + to_string(score[win]) +
+                   ", base " + to_string(score[0]) + " at budget " + to_string(budget);
+    }
+
+    if (best.empty()) {
+        fprintf(stderr, "ERROR! No .cnf files found under %s\n", cfg.dir);
+        return 1;
+    }
+    string comment = "generated by --tune=" + string(cfg.dir) + " mode=" + to_string(cfg.mode) +
+                     " seed=" + to_string(cfg.seed) + " configs=" + to_string(configs) +
+                     " budget=" + to_string(cfg.budget) +
+                     "\nscores are PAR2 in propagations (unsolved = 2 x budget)" + summary;
+    if (!writeConfig(cfg.out, comment, best)) {
+        fprintf(stderr, "ERROR! Could not write config file: %s\n", cfg.out);
+        return 1;
+    }
+    printf("c tune: wrote %s\n", cfg.out);
+    return 0;
+}
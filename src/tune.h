@@ -0,0 +1,26 @@
+#ifndef __TUNE_H
+#define __TUNE_H
+
+#include <cstdint>
+#include "params.h"
+
+// 自動調校設定
+struct TuneConfig
+{
+    const char *dir = nullptr;          // 測資目錄，每個子目錄是一個類別
+    const char *out = "tuned.cfg";      // 輸出的設定檔
+    int         mode = 20;              // 執行模式
+    uint64_t    seed = 1;               // 候選設定的取樣與求解使用的亂數種子
+    int         configs = 16;           // 每個類別的候選設定數（包含基準設定）
+    long long   budget = 100000;        // 第一輪每個測資的傳播數上限，之後每輪加倍
+    int         workers = 0;            // 平行求解的執行緒數（0 表示使用所有核心）
+    SolverParams base;                  // 基準設定，也是第一個候選設定
+};
+
+// 以 successive halving 為每個類別挑選參數：在調校範圍內取樣候選設定，
+// 每輪以相同的傳播數上限平行求解類別中的所有測資，依 PAR2 分數（解出時為傳播數，
+// 否則為上限的兩倍）保留較好的一半，並將上限加倍，直到剩下一個設定。
+// 工作量以傳播數而非時間衡量，相同的輸入與種子得到相同的結果。
+int runTune(const TuneConfig &cfg);
+
+#endif
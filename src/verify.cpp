@@ -0,0 +1,107 @@
+#include "solver.h"
+#include <thread>
+
+/******************************************************
+    Model Verification
+******************************************************/
+
+/// @brief 保留原始（簡化前）子句，以 0 結尾串接在一起
+/// @param raw 解析得到的原始子句
+void solver::keepOriginal(const vector<vector<int>> &raw)
+{
+    size_t total = 0;
+    for (auto &cls : raw)
+        total += cls.size() + 1;
+    oriLits.clear();
+    oriLits.reserve(total);
+    for (auto &cls : raw)
+    {
+        oriLits.insert(oriLits.end(), cls.begin(), cls.end());
+        oriLits.push_back(0);
+    }
+}
+
+
+// 檢查 [begin, end) 範圍內的子句，回傳第一個不滿足子句的起始位置，全部滿足則回傳 -1
+static long long checkRange(const vector<int> &lits, size_t begin, size_t end,
+                            const vector<int> &model)
+{
+    size_t start = begin;
+    bool satisfied = false;
+    for (size_t i = begin; i < end; ++i)
+    {
+        int lit = lits[i];
+        if (lit == 0)
+        {
+            if (!satisfied)
+                return (long long)start;
+            satisfied = false;
+            start = i + 1;
+        }
+        else if (!satisfied && model[abs(lit)] == lit)
+        {
+            satisfied = true;
+        }
+    }
+    return -1;
+}
+
+
+/// @brief 以原始子句驗證模型，將子句切成數段平行檢查
+/// @param model 模型，model[v] 為 v 或 -v
+/// @param threads 使用的執行緒數量
+/// @return 第一個不被滿足的原始子句編號；模型正確則回傳 -1
+long long solver::verifyModel(const vector<int> &model, int threads) const
+{
+    TRACE_SCOPE("verify");
+    // 追蹤 UNSAT core 時模型不含選擇變數
+    if ((int)model.size() <= (trackCore ? coreVars : maxVarIndex))
+        return 0;
+
+    // 子句不多時不值得建立執行緒
+    const size_t minChunk = 1 << 16;
+    size_t n = oriLits.size();
+    threads = max(1, min(threads, (int)(n / minChunk)));
+
+    // 各段的邊界必須對齊子句結尾
+    vector<size_t> bound(threads + 1, n);
+    bound[0] = 0;
+    for (int t = 1; t < threads; ++t)
+    {
+        size_t b = max(bound[t-1], n / threads * t);
+        while (b < n && (b == 0 || oriLits[b-1] != 0))
+            ++b;
+        bound[t] = b;
+    }
+
+    vector<long long> bad(threads, -1);
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t)
+    {
+        pool.emplace_back([&, t] {
+            bad[t] = checkRange(oriLits, bound[t], bound[t+1], model);
+        });
+    }
+    bad[0] = checkRange(oriLits, bound[0], bound[1], model);
+    for (auto &th : pool)
+        th.join();
+
+    // 換算成子句編號
+    for (int t = 0; t < threads; ++t)
+    {
+        if (bad[t] == -1)
+            continue;
+        return (long long)count(oriLits.begin(), oriLits.begin() + bad[t], 0);
+    }
+
+    // 基數約束接在子句之後編號
+    for (size_t i = 0; i < oriCards.size(); ++i)
+    {
+        int cnt = 0;
+        for (int lit : oriCards[i].lit)
+            cnt += model[abs(lit)] == lit;
+        if (cnt > oriCards[i].k)
+            return (long long)count(oriLits.begin(), oriLits.end(), 0) + (long long)i;
+    }
+    return -1;
+}
@@ -0,0 +1,102 @@
+# 投影模型計數測試：以暴力法走訪 CNF 的所有賦值計算投影後的模型數，
+# 並與 sat-solver --enum 及 --enum-minimize 在數種執行模式下回報的 projected count 比較。
+#
+#   cmake -DSOLVER=<sat-solver> -DCNF=<file.cnf> -P enum-count.cmake
+#
+# 只適用於小型的 CNF（變數數即 p cnf 標頭宣告的數量，最多約 12 個）。
+
+foreach(var SOLVER CNF)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "${var} is not set")
+    endif()
+endforeach()
+
+file(STRINGS "${CNF}" lines)
+set(numVars 0)
+set(proj "")
+set(clauses "")
+foreach(line IN LISTS lines)
+    string(STRIP "${line}" line)
+    if(line MATCHES "^p cnf +([0-9]+)")
+        set(numVars ${CMAKE_MATCH_1})
+    elseif(line MATCHES "^c (p show|ind) (.*) 0$")
+        string(REGEX REPLACE " +" ";" vars "${CMAKE_MATCH_2}")
+        list(APPEND proj ${vars})
+    elseif(line MATCHES "^-?[0-9]")
+        # 子句以 ',' 分隔文字，整個子句為清單的一個元素
+        string(REGEX REPLACE " +0$" "" line "${line}")
+        string(REGEX REPLACE " +" "," line "${line}")
+        list(APPEND clauses "${line}")
+    endif()
+endforeach()
+if(proj STREQUAL "")
+    foreach(v RANGE 1 ${numVars})
+        list(APPEND proj ${v})
+    endforeach()
+endif()
+list(REMOVE_DUPLICATES proj)
+
+# 暴力法：第 i 個賦值中變數 v 的值為 i 的第 v-1 個位元
+math(EXPR total "(1 << ${numVars}) - 1")
+set(projected "")
+foreach(i RANGE 0 ${total})
+    set(ok TRUE)
+    foreach(cls IN LISTS clauses)
+        string(REPLACE "," ";" lits "${cls}")
+        set(sat FALSE)
+        foreach(lit IN LISTS lits)
+            if(lit LESS 0)
+                math(EXPR v "-(${lit})")
+                math(EXPR want 0)
+            else()
+                set(v ${lit})
+                set(want 1)
+            endif()
+            math(EXPR val "(${i} >> (${v} - 1)) & 1")
+            if(val EQUAL want)
+                set(sat TRUE)
+                break()
+            endif()
+        endforeach()
+        if(NOT sat)
+            set(ok FALSE)
+            break()
+        endif()
+    endforeach()
+    if(ok)
+        set(key "")
+        foreach(v IN LISTS proj)
+            math(EXPR val "(${i} >> (${v} - 1)) & 1")
+            string(APPEND key "${val}")
+        endforeach()
+        list(APPEND projected "k${key}")
+    endif()
+endforeach()
+list(REMOVE_DUPLICATES projected)
+list(LENGTH projected expected)
+
+set(failed 0)
+foreach(mode 20 948 4116)
+    foreach(flag --enum --enum-minimize)
+        execute_process(
+            COMMAND "${SOLVER}" ${flag} --mode=${mode} "${CNF}"
+            OUTPUT_VARIABLE out
+            ERROR_VARIABLE err
+            RESULT_VARIABLE rc)
+        if(NOT rc EQUAL 0 OR NOT out MATCHES "projected count ([0-9]+)")
+            message(SEND_ERROR "${flag} mode ${mode}: solver failed (exit ${rc})\n${out}${err}")
+            set(failed 1)
+            continue()
+        endif()
+        set(count ${CMAKE_MATCH_1})
+        set(status "ok")
+        if(NOT count EQUAL expected)
+            set(status "FAILED: brute force gives ${expected}")
+            set(failed 1)
+        endif()
+        message(STATUS "${flag} mode ${mode}: projected count ${count} ... ${status}")
+    endforeach()
+endforeach()
+if(failed)
+    message(FATAL_ERROR "Projected model count of ${CNF} is wrong")
+endif()
@@ -0,0 +1,82 @@
+# 搜尋量回歸測試：以固定的種子求解基準檔中的每個測資，
+# 結果不同，或衝突數、傳播數比基準值多出超過 TOLERANCE 百分比時失敗。
+#
+#   cmake -DSOLVER=<sat-solver> -DBENCHMARK_DIR=<benchmark> -DBASELINE=<baseline.txt>
+#         [-DTOLERANCE=<percent>] [-DUPDATE=ON] -P regress.cmake
+#
+# 基準檔每行為 <instance> <mode> <SAT|UNSAT> <conflicts> <propagations>，# 開頭為註解。
+# UPDATE=ON 時以這次的計數重寫基準檔。
+
+set(SEED 1)
+set(TIMEOUT 60)
+if(NOT DEFINED TOLERANCE)
+    set(TOLERANCE 10)
+endif()
+foreach(var SOLVER BENCHMARK_DIR BASELINE)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "${var} is not set")
+    endif()
+endforeach()
+
+file(STRINGS "${BASELINE}" lines ENCODING UTF-8)
+set(failed 0)
+set(updated "")
+foreach(line IN LISTS lines)
+    if(line MATCHES "^#" OR line STREQUAL "")
+        string(APPEND updated "${line}\n")
+        continue()
+    endif()
+    string(REGEX REPLACE "[ \t]+" ";" fields "${line}")
+    list(LENGTH fields n)
+    if(NOT n EQUAL 5)
+        message(FATAL_ERROR "Malformed baseline line: ${line}")
+    endif()
+    list(GET fields 0 inst)
+    list(GET fields 1 mode)
+    list(GET fields 2 baseResult)
+    list(GET fields 3 baseConflicts)
+    list(GET fields 4 baseProps)
+
+    execute_process(
+        COMMAND "${SOLVER}" --stats --verify --seed=${SEED} --mode=${mode} --timeout=${TIMEOUT}
+                "${BENCHMARK_DIR}/${inst}"
+        OUTPUT_VARIABLE out
+        ERROR_VARIABLE err
+        RESULT_VARIABLE rc)
+    if(out MATCHES "UNSATISFIABLE")
+        set(result UNSAT)
+    elseif(out MATCHES "SATISFIABLE")
+        set(result SAT)
+    else()
+        set(result UNKNOWN)
+    endif()
+    if(NOT rc EQUAL 0 OR NOT out MATCHES "conflicts ([0-9]+), propagations ([0-9]+)")
+        message(SEND_ERROR "${inst} mode ${mode}: solver failed (exit ${rc})\n${out}${err}")
+        set(failed 1)
+        string(APPEND updated "${line}\n")
+        continue()
+    endif()
+    set(conflicts ${CMAKE_MATCH_1})
+    set(props ${CMAKE_MATCH_2})
+    string(APPEND updated "${inst} ${mode} ${result} ${conflicts} ${props}\n")
+
+    math(EXPR maxConflicts "${baseConflicts} + ${baseConflicts} * ${TOLERANCE} / 100")
+    math(EXPR maxProps "${baseProps} + ${baseProps} * ${TOLERANCE} / 100")
+    set(status "ok")
+    if(NOT result STREQUAL baseResult)
+        set(status "FAILED: expected ${baseResult}")
+    elseif(conflicts GREATER maxConflicts OR props GREATER maxProps)
+        set(status "FAILED: baseline ${baseConflicts} conflicts, ${baseProps} propagations")
+    endif()
+    message(STATUS "${inst} mode ${mode}: ${result}, ${conflicts} conflicts, ${props} propagations ... ${status}")
+    if(NOT status STREQUAL "ok")
+        set(failed 1)
+    endif()
+endforeach()
+
+if(UPDATE)
+    file(WRITE "${BASELINE}" "${updated}")
+    message(STATUS "Updated ${BASELINE}")
+elseif(failed)
+    message(FATAL_ERROR "Search effort regressed by more than ${TOLERANCE}% (rerun with -DUPDATE=ON to accept)")
+endif()